@@ -1,142 +1,190 @@
 #include "../internal.h"
-#include <regex>
-#include <unordered_set>
+#include <algorithm>
+#include <cwctype>
 
 // BROWSER PROCESS ONLY.
 
-static const std::unordered_set<wstring> known_assets
-{
-    // images
-    L"bmp", L"png",
-    L"jpg", L"jpeg", L"jfif",
-    L"pjpeg", L"pjp", L"gif",
-    L"svg", L"ico", L"webp",
-
-    // media
-    L"avif", L"mp4", L"webm",
-    L"ogg", L"mp3", L"wav",
-    L"flac", L"aac",
-
-    // fonts
-    L"woff", L"woff2",
-    L"eot", L"ttf", L"otf",
-};
+std::shared_ptr<const string> LoadCachedAsset(const wstring &path, int64 size, int64 mtime, bool *hit = nullptr);
+bool ResolvePluginPath(const wstring &request, wstring &path, bool &js);
+bool GetPackedPluginFile(const wstring &path, std::shared_ptr<const void> &owner, const char *&data, size_t &size, int64 &mtime);
+void PreloadPluginModules(const wstring &request);
+bool IsAssetsTraceEnabled();
+void TraceAssetRequest(const assets::Request &request, const assets::Response &response);
 
-static const auto SCRIPT_IMPORT_CSS = u8R"(
-(async function () {
-    if (document.readyState !== 'complete')
-        await new Promise(res => window.addEventListener('load', res));
-
-    const url = import.meta.url.replace(/\?.*$/, '');
-    const link = document.createElement('link');
-    link.setAttribute('rel', 'stylesheet');
-    link.setAttribute('href', url);
-
-    document.body.appendChild(link);
-})();
-)";
-
-static const auto SCRIPT_IMPORT_JSON = u8R"(
-const url = import.meta.url.replace(/\?.*$/, '');
-const content = window.requireFile(url);
-export default JSON.parse(content);
-)";
-
-static const auto SCRIPT_IMPORT_RAW = u8R"(
-const url = import.meta.url.replace(/\?.*$/, '');
-const content = window.requireFile(url);
-export default content;
-)";
-
-static const auto SCRIPT_IMPORT_URL = u8R"(
-const url = import.meta.url.replace(/\?.*$/, '');
-export default url;
-)";
-
-enum ImportType
+// Stat file on disk or packed plugin file.
+static bool StatAsset(const wstring &path, int64 &size, int64 &mtime)
 {
-    IMPORT_DEFAULT = 0,
-    IMPORT_CSS,
-    IMPORT_JSON,
-    IMPORT_RAW,
-    IMPORT_URL
-};
+    std::shared_ptr<const void> owner;
+    const char *data;
+    size_t length;
 
-class ModuleStreamReader : public CefRefCount<cef_stream_reader_t>
-{
-public:
-    ModuleStreamReader(ImportType type) : CefRefCount(this), data_{}
+    if (GetPackedPluginFile(path, owner, data, length, mtime))
     {
-        cef_stream_reader_t::read = _read;
-        cef_stream_reader_t::seek = _seek;
-        cef_stream_reader_t::tell = _tell;
+        size = static_cast<int64>(length);
+        return true;
+    }
 
-        switch (type)
-        {
-            case IMPORT_CSS:
-                data_.assign(SCRIPT_IMPORT_CSS);
-                break;
-            case IMPORT_JSON:
-                data_.assign(SCRIPT_IMPORT_JSON);
-                break;
-            case IMPORT_RAW:
-                data_.assign(SCRIPT_IMPORT_RAW);
-                break;
-            case IMPORT_URL:
-                data_.assign(SCRIPT_IMPORT_URL);
-                break;
-        }
+    return utils::statFile(path, size, mtime);
+}
+
+// Get read-only view of file content, kept alive by owner.
+static bool OpenFileView(const wstring &path, int64 size, int64 mtime,
+    std::shared_ptr<const void> &owner, const char *&data, int64 &length, bool *cached = nullptr)
+{
+    size_t packed_size;
 
-        stream_ = CefStreamReader_CreateForData(
-            const_cast<char *>(data_.c_str()), data_.length());
+    // Packed files are already mapped.
+    if (GetPackedPluginFile(path, owner, data, packed_size, mtime))
+    {
+        length = static_cast<int64>(packed_size);
+        return true;
     }
 
-    ~ModuleStreamReader()
+    // Serve small files from shared cache.
+    if (auto content = LoadCachedAsset(path, size, mtime, cached))
     {
-        data_.clear();
-        if (stream_ != nullptr)
-            stream_->base.release(&stream_->base);
+        data = content->c_str();
+        length = static_cast<int64>(content->length());
+        owner = content;
+        return true;
     }
 
-private:
-    string data_;
-    cef_stream_reader_t *stream_;
+    // Map large files, they never get copied into heap.
+    auto mapping = std::make_shared<utils::FileMapping>();
+    if (mapping->open(path))
+    {
+        data = mapping->data();
+        length = static_cast<int64>(mapping->size());
+        owner = mapping;
+        return true;
+    }
+
+    return false;
+}
+
+// Get content of asset file by full path, for other browser modules.
+bool LoadAssetContent(const wstring &path, int64 &mtime,
+    std::shared_ptr<const void> &owner, const char *&data, int64 &length)
+{
+    int64 size;
+    return StatAsset(path, size, mtime) && OpenFileView(path, size, mtime, owner, data, length);
+}
 
-    static size_t CEF_CALLBACK _read(struct _cef_stream_reader_t* _,
-        void* ptr,
-        size_t size,
-        size_t n)
+// Drop "/__r<token>" prefix of hot-reloaded plugin URLs, see hotreload.cc.
+static void StripReloadToken(wstring &path)
+{
+    if (path.compare(0, 4, L"/__r") != 0)
+        return;
+
+    size_t end = 4;
+    while (end < path.length() && iswdigit(path[end]))
+        end++;
+
+    if (end > 4 && end < path.length() && path[end] == L'/')
+        path.erase(0, end);
+}
+
+// Plugins index, packs, shared cache and disk.
+class DiskSource : public assets::Source
+{
+public:
+    bool locate(const wstring &request, bool plugin, wstring &path, bool &js) override
     {
-        auto self = static_cast<ModuleStreamReader *>(_);
-        return self->stream_->read(self->stream_, ptr, size, n);
+        js = false;
+
+        if (plugin)
+            return ResolvePluginPath(request, path, js);
+
+        path = config::getAssetsDir().append(request);
+        return true;
     }
 
-    static int CEF_CALLBACK _seek(struct _cef_stream_reader_t* _,
-        int64 offset,
-        int whence)
+    bool stat(const wstring &path, int64 &size, int64 &mtime) override
     {
-        auto self = static_cast<ModuleStreamReader *>(_);
-        return self->stream_->seek(self->stream_, offset, whence);
+        return StatAsset(path, size, mtime);
     }
 
-    static int64 CEF_CALLBACK _tell(struct _cef_stream_reader_t* _)
+    bool open(const wstring &path, int64 size, int64 mtime,
+        std::shared_ptr<const void> &owner, const char *&data, int64 &length, bool *cached) override
     {
-        auto self = static_cast<ModuleStreamReader *>(_);
-        return self->stream_->tell(self->stream_);
+        return OpenFileView(path, size, mtime, owner, data, length, cached);
     }
 };
 
+assets::Source &assets::diskSource()
+{
+    static DiskSource source{};
+    return source;
+}
+
+// File work runs off the CEF IO thread, slow disks or AV scans must not
+// stall other requests. Over the limit, opens fall back to run inline.
+static const size_t OPEN_THREADS = 4;
+static const size_t MAX_PENDING_OPENS = 64;
+
+static std::atomic<int64> opens_peak_{ 0 };
+static std::atomic<int64> opens_inline_{ 0 };
+
+static utils::WorkerPool &GetOpenPool()
+{
+    static auto pool = new utils::WorkerPool(OPEN_THREADS, MAX_PENDING_OPENS);
+    return *pool;
+}
+
+static void UpdateOpensPeak()
+{
+    int64 pending = static_cast<int64>(GetOpenPool().pending());
+    int64 peak = opens_peak_;
+
+    while (pending > peak && !opens_peak_.compare_exchange_weak(peak, pending));
+}
+
+void GetAssetsOpenStats(int64 &pending, int64 &peak, int64 &inline_opens)
+{
+    pending = static_cast<int64>(GetOpenPool().pending());
+    peak = opens_peak_;
+    inline_opens = opens_inline_;
+}
+
+#ifdef LL_ALLOC_STATS
+// Heap allocations made while reading response bodies, should stay zero.
+static std::atomic<int64> read_allocs_{ 0 };
+
+struct AllocScope
+{
+    int64 start = utils::allocCount();
+    ~AllocScope() { read_allocs_ += utils::allocCount() - start; }
+};
+
+#define ALLOC_SCOPE() AllocScope _alloc_scope
+#else
+#define ALLOC_SCOPE()
+#endif
+
+// -1 if this build doesn't count allocations.
+int64 GetAssetsReadAllocs()
+{
+#ifdef LL_ALLOC_STATS
+    return read_allocs_;
+#else
+    return -1;
+#endif
+}
+
 // Custom resource handler for local assets.
 class AssetsResourceHandler : public CefRefCount<cef_resource_handler_t>
 {
 public:
     AssetsResourceHandler(const wstring &path, bool plugin) : CefRefCount(this)
         , path_(path)
+        , response_{}
         , mime_{}
+        , offset_(0)
         , stream_(nullptr)
-        , length_(0)
+        , start_(0)
+        , first_byte_(false)
         , is_plugin_(plugin)
-        , no_cache_(false)
+        , canceled_(false)
     {
         cef_resource_handler_t::open = _Open;
         cef_resource_handler_t::process_request = _ProcessRequest;
@@ -154,132 +202,119 @@ public:
     }
 
 private:
-    cef_stream_reader_t *stream_;
-    int64 length_;
     wstring path_;
+    // Status, headers and memory view of content.
+    assets::Response response_;
     wstring mime_;
+    int64 offset_;
+    // File stream if content couldn't be mapped.
+    cef_stream_reader_t *stream_;
+    // For metrics.
+    int64 start_;
+    bool first_byte_;
     bool is_plugin_;
-    bool no_cache_;
+    std::atomic<bool> canceled_;
 
     int CEF_CALLBACK Open(cef_request_t* request, int* handle_request, cef_callback_t* callback)
     {
-        size_t pos;
-        wstring query_part{};
-        wstring path_ = this->path_;
-        bool js_mime = false;
+        start_ = utils::tickMicros();
+
+        // Keep them alive until the worker is done.
+        base.add_ref(&base);
+        request->base.add_ref(&request->base);
+        callback->base.add_ref(&callback->base);
 
-        // Check query part.
-        if ((pos = path_.find(L'?')) != string::npos)
+        bool posted = GetOpenPool().post([this, request, callback]
         {
-            // Extract it.
-            query_part = path_.substr(pos + 1);
-            // Remove it from path.
-            path_ = path_.substr(0, pos);
+            OpenFile(request);
+
+            if (!canceled_)
+                callback->cont(callback);
+
+            callback->base.release(&callback->base);
+            request->base.release(&request->base);
+            base.release(&base);
+        });
+
+        if (posted)
+        {
+            UpdateOpensPeak();
+            // Resume by callback.
+            *handle_request = false;
+            return true;
         }
 
-        CefScopedStr path_tmp { CefURIDecode(&CefStr(path_), true,
+        callback->base.release(&callback->base);
+        request->base.release(&request->base);
+        base.release(&base);
+
+        // Too many pending opens, do it right here.
+        ++opens_inline_;
+        OpenFile(request);
+
+        *handle_request = true;
+        return true;
+    }
+
+    void OpenFile(cef_request_t *request)
+    {
+        assets::Request params{};
+        size_t pos = path_.find(L'?');
+
+        // Split query part.
+        if (pos != wstring::npos)
+            params.query = path_.substr(pos + 1);
+
+        CefScopedStr path { CefURIDecode(&CefStr(path_.substr(0, pos)), true,
             static_cast<cef_uri_unescape_rule_t>(UU_SPACES | UU_URL_SPECIAL_CHARS_EXCEPT_PATH_SEPARATORS)) };
-        path_ = path_tmp.cstr();
+        params.path = path.cstr();
+        params.plugin = is_plugin_;
+
+        if (is_plugin_)
+            StripReloadToken(params.path);
 
-        // Get final path.
         if (is_plugin_)
         {
-            path_ = config::getPluginsDir().append(path_);
+            CefScopedStr referer{ request->get_referrer_url(request) };
+            params.referrer = referer.cstr();
+        }
 
-            // Trailing slash.
-            if (path_[path_.length() - 1] == '/' || path_[path_.length() - 1] == L'\\')
-            {
-                js_mime = true;
-                path_.append(L"index.js");
-            }
-            else
-            {
-                size_t pos = path_.find_last_of(L"//\\");
-                wstring sub = path_.substr(pos + 1);
-
-                // No extension.
-                if (sub.find_last_of(L'.') == wstring::npos)
-                {
-                    // peek .js
-                    if (js_mime = utils::fileExist(path_ + L".js"))
-                        path_.append(L".js");
-                    // peek folder
-                    else if (js_mime = utils::dirExist(path_))
-                        path_.append(L"/index.js");
-                }
-            }
+        params.header = [request](const char *name)
+        {
+            CefScopedStr value{ request->get_header_by_name(request, &CefStr(name, strlen(name))) };
+            return value.cstr();
+        };
 
-            if (utils::fileExist(path_))
-            {
-                auto import = IMPORT_DEFAULT;
-
-                static const std::wregex module_pattern{ L"^https:\\/\\/plugins.*\\.js(?:\\?.*)?$" };
-                CefScopedStr referer{ request->get_referrer_url(request) };
-
-                // Detect relative plugin imports by referer //plugins.
-                if (!referer.empty() && std::regex_search(wstring(referer.str, referer.length), module_pattern))
-                {
-                    static const std::wregex raw_pattern{ L"\\braw\\b" };
-                    static const std::wregex url_pattern{ L"\\burl\\b" };
-
-                    if (std::regex_search(query_part, url_pattern))
-                        import = IMPORT_URL;
-                    else if (std::regex_search(query_part, raw_pattern))
-                        import = IMPORT_RAW;
-                    else if ((pos = path_.find_last_of(L'.')) != string::npos)
-                    {
-                        auto ext = path_.substr(pos + 1);
-                        if (ext == L"css")
-                            import = IMPORT_CSS;
-                        else if (ext == L"json")
-                            import = IMPORT_JSON;
-                        else if (known_assets.find(ext) != known_assets.end())
-                            import = IMPORT_URL;
-                    }
-                }
-
-                if (import != IMPORT_DEFAULT)
-                {
-                    js_mime = true;
-                    stream_ = new ModuleStreamReader(import);
-                }
-                else
-                {
-                    stream_ = CefStreamReader_CreateForFile(&CefStr(path_));
-                }
-            }
-        }
-        else
+        assets::serve(assets::diskSource(), params, response_);
+
+        if (response_.preload)
+            PreloadPluginModules(params.path);
+
+        if (response_.data == nullptr && response_.status != 404 && response_.status != 304)
         {
-            path_ = config::getAssetsDir().append(path_);
-            stream_ = CefStreamReader_CreateForFile(&CefStr(path_));
+            if ((stream_ = CefStreamReader_CreateForFile(&CefStr(response_.path))) == nullptr)
+                response_.status = 404;
         }
 
-        if (stream_ != nullptr)
+        // Ask CEF for the rest of MIME types.
+        if (HasContent() && response_.mime == nullptr
+            && (pos = response_.path.find_last_of(L'.')) != wstring::npos)
         {
-            stream_->seek(stream_, 0, SEEK_END);
-            length_ = stream_->tell(stream_);
-            stream_->seek(stream_, 0, SEEK_SET);
-
-            if (js_mime)
-            {
-                // Already known JavaScript module.
-                mime_.assign(L"text/javascript");
-                no_cache_ = true;
-            }
-            else if ((pos = path_.find_last_of(L'.')) != string::npos)
-            {
-                // Get MIME type from file extension.
-                auto ext = path_.substr(pos + 1);
-                CefScopedStr type{ CefGetMimeType(&CefStr(ext)) };
-                if (!type.empty())
-                    mime_.assign(type.str, type.length);
-            }
+            CefScopedStr type{ CefGetMimeType(&CefStr(response_.path.substr(pos + 1))) };
+            if (!type.empty())
+                mime_.assign(type.str, type.length);
         }
 
-        *handle_request = true;
-        callback->cont(callback);
-        return true;
+        if (IsAssetsTraceEnabled())
+            TraceAssetRequest(params, response_);
+
+        metrics::recordOpen(GetRoute(), response_.import, response_.status,
+            utils::tickMicros() - start_, response_.cache_hit);
+    }
+
+    metrics::Route GetRoute() const
+    {
+        return is_plugin_ ? metrics::ROUTE_PLUGINS : metrics::ROUTE_ASSETS;
     }
 
     static void CEF_CALLBACK _GetResponseHeaders(cef_resource_handler_t* _,
@@ -288,9 +323,20 @@ private:
         cef_string_t* redirectUrl)
     {
         auto self = static_cast<AssetsResourceHandler *>(_);
+        const auto &r = self->response_;
+
+        if (r.status == 304)
+        {
+            response->set_status(response, 304);
+            response->set_error(response, ERR_NONE);
+
+            response->set_header_by_name(response, &"Access-Control-Allow-Origin"_s, &"*"_s, 1);
+            self->SetCacheHeaders(response);
 
+            *response_length = 0;
+        }
         // File not found.
-        if (self->stream_ == nullptr)
+        else if (!self->HasContent())
         {
             response->set_status(response, 404);
             response->set_error(response, ERR_FILE_NOT_FOUND);
@@ -299,24 +345,40 @@ private:
         }
         else
         {
-            response->set_status(response, 200);
+            response->set_status(response, r.status);
             response->set_error(response, ERR_NONE);
 
             // Set MIME type.
-            if (!self->mime_.empty())
+            if (r.mime != nullptr)
+                response->set_mime_type(response, &CefStr(r.mime, strlen(r.mime)));
+            else if (!self->mime_.empty())
                 response->set_mime_type(response, &CefStr(self->mime_));
 
             response->set_header_by_name(response, &"Access-Control-Allow-Origin"_s, &"*"_s, 1);
+            response->set_header_by_name(response, &"Accept-Ranges"_s, &"bytes"_s, 1);
+
+            if (!r.range.empty())
+                response->set_header_by_name(response, &"Content-Range"_s, &CefStr(r.range), 1);
 
-            if (self->no_cache_ || self->mime_ == L"text/javascript")
-                response->set_header_by_name(response, &"Cache-Control"_s, &"no-cache, no-store, must-revalidate"_s, 1);
-            else
-                response->set_header_by_name(response, &"Cache-Control"_s, &"public, max-age=86400"_s, 1);
+            self->SetCacheHeaders(response);
 
-            *response_length = self->length_;
+            *response_length = r.length;
         }
     }
 
+    void SetCacheHeaders(cef_response_t *response)
+    {
+        // Fingerprinted content never changes, others always revalidate.
+        if (response_.immutable)
+            response->set_header_by_name(response, &"Cache-Control"_s, &"public, max-age=31536000, immutable"_s, 1);
+        else
+            response->set_header_by_name(response, &"Cache-Control"_s, &"no-cache"_s, 1);
+        response->set_header_by_name(response, &"ETag"_s, &CefStr(response_.etag), 1);
+
+        if (!response_.last_modified.empty())
+            response->set_header_by_name(response, &"Last-Modified"_s, &CefStr(response_.last_modified), 1);
+    }
+
     static int CEF_CALLBACK _Read(cef_resource_handler_t* _,
         void* data_out,
         int bytes_to_read,
@@ -324,20 +386,48 @@ private:
         struct _cef_resource_read_callback_t* callback)
     {
         auto self = static_cast<AssetsResourceHandler *>(_);
+        ALLOC_SCOPE();
 
         int read = 0;
         auto stream = self->stream_;
+        const auto &r = self->response_;
         *bytes_read = 0;
 
-        do
+        // One bulk copy from memory view.
+        if (r.data != nullptr)
+        {
+            *bytes_read = assets::readBody(r, self->offset_, data_out, bytes_to_read);
+        }
+        else if (stream != nullptr)
+        {
+            do
+            {
+                read = static_cast<int>(stream->read(stream, static_cast<char*>(data_out) + *bytes_read, 1, bytes_to_read - *bytes_read));
+                *bytes_read += read;
+            } while (read != 0 && *bytes_read < bytes_to_read);
+
+            self->offset_ += *bytes_read;
+        }
+
+        if (*bytes_read > 0)
         {
-            read = static_cast<int>(stream->read(stream, static_cast<char*>(data_out) + *bytes_read, 1, bytes_to_read - *bytes_read));
-            *bytes_read += read;
-        } while (read != 0 && *bytes_read < bytes_to_read);
+            if (!self->first_byte_)
+            {
+                self->first_byte_ = true;
+                metrics::recordFirstByte(self->GetRoute(), r.import, utils::tickMicros() - self->start_);
+            }
+
+            metrics::recordBytes(self->GetRoute(), r.import, *bytes_read);
+        }
 
         return (*bytes_read > 0);
     }
 
+    bool HasContent() const
+    {
+        return response_.data != nullptr || stream_ != nullptr;
+    }
+
     static int CEF_CALLBACK _Open(cef_resource_handler_t* _,
         struct _cef_request_t* request,
         int* handle_request,
@@ -351,11 +441,28 @@ private:
         struct _cef_request_t* request,
         struct _cef_callback_t* callback) { return 0; }
 
-    // Ignored
-    static int CEF_CALLBACK _Skip(cef_resource_handler_t* self,
+    static int CEF_CALLBACK _Skip(cef_resource_handler_t* _,
         int64 bytes_to_skip,
         int64* bytes_skipped,
-        struct _cef_resource_skip_callback_t* callback) { return 0; }
+        struct _cef_resource_skip_callback_t* callback)
+    {
+        auto self = static_cast<AssetsResourceHandler *>(_);
+        ALLOC_SCOPE();
+
+        auto stream = self->stream_;
+        int64 skip = std::min(bytes_to_skip, self->response_.length - self->offset_);
+
+        if (skip < 0 || !self->HasContent()
+            || (stream != nullptr && stream->seek(stream, skip, SEEK_CUR) != 0))
+        {
+            *bytes_skipped = ERR_FAILED;
+            return false;
+        }
+
+        self->offset_ += skip;
+        *bytes_skipped = skip;
+        return true;
+    }
 
     // Deprecated
     static int CEF_CALLBACK _ReadResponse(cef_resource_handler_t* self,
@@ -364,10 +471,13 @@ private:
         int* bytes_read,
         struct _cef_callback_t* callback) { return 0; }
 
-    static void CEF_CALLBACK _Cancel(cef_resource_handler_t* self) { }
+    static void CEF_CALLBACK _Cancel(cef_resource_handler_t* self)
+    {
+        static_cast<AssetsResourceHandler *>(self)->canceled_ = true;
+    }
 };
 
 cef_resource_handler_t *CreateAssetsResourceHandler(const wstring &path, bool plugin)
 {
     return new AssetsResourceHandler(path, plugin);
-}
+}
\ No newline at end of file
@@ -0,0 +1,275 @@
+#include "../common.h"
+#include <string.h>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cwctype>
+
+// Assets trace and its replay through assets::serve without the client,
+// to measure changes of assets serving. Recorded by browser/replay.cc.
+//
+// Trace is UTF-8, one request per line, tab separated fields:
+//   plugin, path, query, referrer, If-None-Match, If-Modified-Since, Range,
+//   status, import, file, size, mtime
+// Files are relative to plugins/assets folder.
+
+static const char *TRACE_HEADERS[] = { "If-None-Match", "If-Modified-Since", "Range" };
+static const size_t TRACE_FIELDS = 12;
+
+// Roots of synthetic tree, never touch disk.
+static const wchar_t SYNTHETIC_PLUGINS[] = L"replay:\\plugins";
+static const wchar_t SYNTHETIC_ASSETS[] = L"replay:\\assets";
+
+static void AppendField(string &line, const wstring &value)
+{
+    auto narrow = utils::toNarrow(value);
+    for (auto &c : narrow)
+        if (c == '\t' || c == '\r' || c == '\n') c = ' ';
+
+    line.append(narrow).push_back('\t');
+}
+
+string assets::formatTrace(const Request &request, const Response &response, const wstring &file)
+{
+    string line{};
+    AppendField(line, request.plugin ? L"1" : L"0");
+    AppendField(line, request.path);
+    AppendField(line, request.query);
+    AppendField(line, request.referrer);
+
+    for (auto name : TRACE_HEADERS)
+        AppendField(line, request.header(name));
+
+    AppendField(line, std::to_wstring(response.status));
+    AppendField(line, std::to_wstring(response.import));
+    AppendField(line, file);
+    AppendField(line, std::to_wstring(response.size));
+    AppendField(line, std::to_wstring(response.mtime));
+    line.back() = '\n';
+
+    return line;
+}
+
+static vector<wstring> SplitFields(const string &line)
+{
+    vector<wstring> fields{};
+    size_t start = 0;
+
+    while (start <= line.length())
+    {
+        size_t end = line.find('\t', start);
+        if (end == string::npos) end = line.length();
+
+        fields.push_back(utils::toWide(line.substr(start, end - start)));
+        start = end + 1;
+    }
+
+    return fields;
+}
+
+// Header names are case-insensitive.
+static bool SameHeader(const char *a, const char *b)
+{
+    for (; *a && *b; a++, b++)
+        if (tolower(static_cast<unsigned char>(*a)) != tolower(static_cast<unsigned char>(*b)))
+            return false;
+
+    return *a == *b;
+}
+
+void assets::parseTrace(const string &content, vector<std::unique_ptr<TraceRecord>> &records)
+{
+    size_t start = 0;
+    while (start < content.length())
+    {
+        size_t end = content.find('\n', start);
+        if (end == string::npos) end = content.length();
+
+        auto fields = SplitFields(content.substr(start, end - start));
+        start = end + 1;
+
+        if (fields.size() != TRACE_FIELDS)
+            continue;
+
+        auto record = std::unique_ptr<TraceRecord>(new TraceRecord{});
+        auto rec = record.get();
+        size_t i = 0;
+
+        rec->request.plugin = fields[i++] == L"1";
+        rec->request.path = fields[i++];
+        rec->request.query = fields[i++];
+        rec->request.referrer = fields[i++];
+
+        for (auto &header : rec->headers)
+            header = fields[i++];
+
+        rec->request.header = [rec](const char *name)
+        {
+            for (size_t h = 0; h < COUNT_OF(TRACE_HEADERS); h++)
+                if (SameHeader(TRACE_HEADERS[h], name))
+                    return rec->headers[h];
+            return wstring{};
+        };
+
+        rec->status = static_cast<int>(wcstol(fields[i++].c_str(), nullptr, 10));
+        i++; // import
+        rec->path = fields[i++];
+        rec->size = wcstoll(fields[i++].c_str(), nullptr, 10);
+        rec->mtime = wcstoll(fields[i++].c_str(), nullptr, 10);
+
+        records.push_back(std::move(record));
+    }
+}
+
+static wstring MakeKey(const wstring &path)
+{
+    auto key = path;
+    for (auto &c : key)
+        c = c == L'\\' ? L'/' : towlower(c);
+    return key;
+}
+
+void assets::SyntheticSource::add(bool plugin, const wstring &path, int64 size, int64 mtime)
+{
+    if (path.empty() || size < 0)
+        return;
+
+    auto content = std::make_shared<string>(static_cast<size_t>(size), 'a');
+    for (size_t i = 79; i < content->length(); i += 80)
+        (*content)[i] = '\n';
+
+    files_[MakeKey((plugin ? SYNTHETIC_PLUGINS : SYNTHETIC_ASSETS) + path)] = File{ content, mtime };
+
+    if (!plugin)
+        return;
+
+    // Same index as plugins resolver, with parent folders.
+    auto key = MakeKey(path);
+    while (!key.empty() && key[0] == L'/')
+        key.erase(0, 1);
+    if (key.empty())
+        return;
+
+    index_[key] = Entry{ false, path.substr(path.find_first_not_of(L'\\')) };
+    for (size_t pos = 0; (pos = key.find(L'/', pos)) != wstring::npos; pos++)
+        index_[key.substr(0, pos)] = Entry{ true, L"" };
+}
+
+bool assets::SyntheticSource::locate(const wstring &request, bool plugin, wstring &path, bool &js)
+{
+    js = false;
+
+    if (!plugin)
+    {
+        path = SYNTHETIC_ASSETS + request;
+        return true;
+    }
+
+    wstring resolved{};
+    bool found = PluginsIndex::ResolveWith(request, resolved, js, [this](const wstring &key, bool &dir, wstring &entry)
+    {
+        auto it = index_.find(key);
+        if (it == index_.end())
+            return false;
+
+        dir = it->second.dir;
+        if (!dir) entry = it->second.path;
+        return true;
+    });
+
+    if (found)
+        path = SYNTHETIC_PLUGINS + (L"\\" + resolved);
+
+    return found;
+}
+
+bool assets::SyntheticSource::stat(const wstring &path, int64 &size, int64 &mtime)
+{
+    auto it = files_.find(MakeKey(path));
+    if (it == files_.end())
+        return false;
+
+    size = static_cast<int64>(it->second.content->length());
+    mtime = it->second.mtime;
+    return true;
+}
+
+bool assets::SyntheticSource::open(const wstring &path, int64, int64,
+    std::shared_ptr<const void> &owner, const char *&data, int64 &length, bool *cached)
+{
+    auto it = files_.find(MakeKey(path));
+    if (it == files_.end())
+        return false;
+
+    data = it->second.content->data();
+    length = static_cast<int64>(it->second.content->length());
+    owner = it->second.content;
+
+    if (cached != nullptr)
+        *cached = true;
+    return true;
+}
+
+static double GetPercentile(const vector<int64> &sorted, double p)
+{
+    if (sorted.empty())
+        return 0;
+
+    size_t i = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return static_cast<double>(sorted[i]);
+}
+
+assets::ReplayResult assets::replay(Source &source, const vector<std::unique_ptr<TraceRecord>> &records, int iterations)
+{
+    using clock = std::chrono::steady_clock;
+
+    ReplayResult result{ records.size(), iterations, 0, 0, 0, 0, 0, -1 };
+    vector<int64> nanos{};
+    nanos.reserve(records.size() * static_cast<size_t>(std::max(iterations, 0)));
+
+    for (int n = 0; n < iterations; n++)
+    {
+        for (const auto &rec : records)
+        {
+            Response response{};
+
+            auto begin = clock::now();
+            serve(source, rec->request, response);
+            auto end = clock::now();
+
+            nanos.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+            if (response.status != rec->status) result.mismatches++;
+        }
+    }
+
+    if (nanos.empty())
+        return result;
+
+    int64 total = 0;
+    for (auto t : nanos)
+        total += t;
+
+    std::sort(nanos.begin(), nanos.end());
+
+    result.per_second = total > 0 ? nanos.size() * 1e9 / total : 0;
+    result.p50_us = GetPercentile(nanos, 0.5) / 1000;
+    result.p99_us = GetPercentile(nanos, 0.99) / 1000;
+    result.max_us = nanos.back() / 1000.0;
+    return result;
+}
+
+string assets::formatReplay(const ReplayResult &result, const char *source)
+{
+    size_t count = result.requests * static_cast<size_t>(std::max(result.iterations, 0));
+
+    char report[512];
+    snprintf(report, sizeof(report),
+        "source: %s\nrequests: %zu x %d\nrequests/s: %.0f\np50: %.2f us\np99: %.2f us\nmax: %.2f us\n"
+        "allocs/request: %.2f\nstatus mismatches: %lld\n",
+        source, result.requests, result.iterations, result.per_second,
+        result.p50_us, result.p99_us, result.max_us,
+        result.allocs < 0 || count == 0 ? -1.0 : static_cast<double>(result.allocs) / count,
+        static_cast<long long>(result.mismatches));
+
+    return report;
+}
\ No newline at end of file
@@ -25,6 +25,8 @@ void SetRiotClientCredentials(const wstring &appPort, const wstring &authToken);
 void OpenInternalServer();
 void CloseInternalServer();
 
+void PreparePluginsIndex();
+
 cef_jsdialog_handler_t *CreateCustomJSDialogHandler();
 
 static decltype(cef_life_span_handler_t::on_after_created) Old_OnAfterCreated;
@@ -174,6 +176,15 @@ static void HookClient(cef_client_t *client)
             CefScopedStr name{ message->get_name(message) };
             if (name == L"__OPEN_DEVTOOLS")
                 OpenDevTools_Internal(false);
+            else if (name == L"__plugin_loaded")
+            {
+                auto args = message->get_argument_list(message);
+                CefScopedStr plugin{ args->get_string(args, 0) };
+                CefScopedStr error{ args->get_string(args, 3) };
+
+                metrics::recordPluginLoad(plugin.cstr(), args->get_bool(args, 1) != 0,
+                    static_cast<int64>(args->get_double(args, 2)), error.cstr());
+            }
         }
 
         return OnProcessMessageReceived(self, browser, frame, source_process, message);
@@ -260,10 +271,16 @@ static void CEF_CALLBACK Hooked_OnBeforeCommandLineProcessing(
 static int Hooked_CefInitialize(const struct _cef_main_args_t* args,
     const struct _cef_settings_t* settings, cef_app_t* app, void* windows_sandbox_info)
 {
+    trace::start();
+    TRACE_SPAN("CefInitialize");
+
     // Hook command line.
     Old_OnBeforeCommandLineProcessing = app->on_before_command_line_processing;
     app->on_before_command_line_processing = Hooked_OnBeforeCommandLineProcessing;
 
+    // Scan plugins folder in background.
+    PreparePluginsIndex();
+
     return CefInitialize(args, settings, app, windows_sandbox_info);
 }
 
@@ -0,0 +1,86 @@
+#include "../internal.h"
+
+// BROWSER PROCESS ONLY.
+
+// Bigger files are streamed from disk instead.
+static const int64 MAX_ENTRY_SIZE = 4 * 1024 * 1024;
+// Default budget in MB, can be changed by AssetsCacheSize in config.
+static const int64 DEFAULT_CACHE_SIZE = 64;
+
+// Process-wide content cache, LRU by bytes.
+class AssetCache
+{
+public:
+    AssetCache() : budget_(-1)
+    {
+    }
+
+    std::shared_ptr<const string> Load(const wstring &path, int64 size, int64 mtime, bool *hit)
+    {
+        if (size > MAX_ENTRY_SIZE || size > GetBudget())
+            return nullptr;
+
+        if (auto data = cache_.find(path, size, mtime))
+        {
+            if (hit) *hit = true;
+            return data;
+        }
+
+        // Read outside the lock, other requests must not wait for disk.
+        auto content = std::make_shared<string>();
+        if (!utils::readFile(path, *content) || static_cast<int64>(content->length()) != size)
+            return content->empty() ? nullptr : content;
+
+        cache_.insert(path, size, mtime, size, content, GetBudget());
+        return content;
+    }
+
+    // Drop entries under folder.
+    void Evict(const wstring &prefix)
+    {
+        cache_.evict([&prefix](const wstring &path)
+        {
+            return _wcsnicmp(path.c_str(), prefix.c_str(), prefix.length()) == 0;
+        });
+    }
+
+    void GetStats(int64 &hits, int64 &misses, int64 &evictions, int64 &bytes)
+    {
+        int64 entries;
+        cache_.getStats(hits, misses, evictions, bytes, entries);
+    }
+
+private:
+    utils::LruByteCache<string> cache_;
+    std::atomic<int64> budget_;
+
+    int64 GetBudget()
+    {
+        if (budget_ < 0)
+        {
+            auto value = config::getConfigValue(L"AssetsCacheSize");
+            int64 mb = value.empty() ? DEFAULT_CACHE_SIZE : wcstol(value.c_str(), nullptr, 10);
+            budget_ = mb > 0 ? mb * 1024 * 1024 : 0;
+        }
+
+        return budget_;
+    }
+};
+
+static AssetCache cache_;
+
+// Get file content by its identity from stat.
+std::shared_ptr<const string> LoadCachedAsset(const wstring &path, int64 size, int64 mtime, bool *hit)
+{
+    return cache_.Load(path, size, mtime, hit);
+}
+
+void GetAssetCacheStats(int64 &hits, int64 &misses, int64 &evictions, int64 &bytes)
+{
+    cache_.GetStats(hits, misses, evictions, bytes);
+}
+
+void EvictCachedAssets(const wstring &prefix)
+{
+    cache_.Evict(prefix);
+}
\ No newline at end of file
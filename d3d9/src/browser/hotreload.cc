@@ -0,0 +1,69 @@
+#include "../internal.h"
+
+// BROWSER PROCESS ONLY.
+
+extern cef_browser_t *browser_;
+
+bool ResolvePluginPath(const wstring &request, wstring &path, bool &js);
+bool LoadAssetContent(const wstring &path, int64 &mtime,
+    std::shared_ptr<const void> &owner, const char *&data, int64 &length);
+void EvictCachedAssets(const wstring &prefix);
+
+// Bumped by each change, see GetPluginEntryURL.
+static std::atomic<int> reload_token_{ 0 };
+
+// Entry URL with content version, under a fresh /__r<token>/ segment. Relative
+// imports resolve under the same segment, so the whole plugin is new to the
+// module map, not only its index.js. Assets handler drops the segment.
+static wstring GetPluginEntryURL(const wstring &name, int token)
+{
+    wstring path{};
+    bool js;
+
+    std::shared_ptr<const void> owner;
+    const char *data;
+    int64 length, mtime;
+
+    if (!ResolvePluginPath(L"/" + name + L"/index.js", path, js)
+        || !LoadAssetContent(path, mtime, owner, data, length))
+        return L"";
+
+    wchar_t version[17];
+    swprintf(version, COUNT_OF(version), L"%016llx",
+        utils::hashContent(data, static_cast<size_t>(length)));
+
+    return L"https://plugins/__r" + std::to_wstring(token) + L"/" + name + L"/index.js?v=" + version;
+}
+
+// Called by plugins watcher once changes have settled.
+void NotifyPluginsChanged(const vector<wstring> &plugins)
+{
+    vector<std::pair<wstring, wstring>> changes{};
+
+    for (const auto &name : plugins)
+    {
+        // Stale entries would be dropped on next load anyway, free them now.
+        EvictCachedAssets(config::getPluginsDir() + L"\\" + name + L"\\");
+        // Empty URL for removed plugin.
+        changes.emplace_back(name, GetPluginEntryURL(name, ++reload_token_));
+    }
+
+    // Browser and frames belong to UI thread.
+    CefPostTask(TID_UI, new CefFunctionTask([changes]
+    {
+        if (browser_ == nullptr)
+            return;
+
+        auto frame = browser_->get_main_frame(browser_);
+
+        for (const auto &change : changes)
+        {
+            auto message = CefProcessMessage_Create(&"__plugin_changed"_s);
+            auto args = message->get_argument_list(message);
+
+            args->set_string(args, 0, &CefStr(change.first));
+            args->set_string(args, 1, &CefStr(change.second));
+            frame->send_process_message(frame, PID_RENDERER, message);
+        }
+    }));
+}
\ No newline at end of file
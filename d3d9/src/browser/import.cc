@@ -0,0 +1,103 @@
+#include "../common.h"
+#include <cwchar>
+
+// BROWSER PROCESS ONLY.
+
+static const wchar_t *known_assets[]
+{
+    // images
+    L"bmp", L"png",
+    L"jpg", L"jpeg", L"jfif",
+    L"pjpeg", L"pjp", L"gif",
+    L"svg", L"ico", L"webp",
+
+    // media
+    L"avif", L"mp4", L"webm",
+    L"ogg", L"mp3", L"wav",
+    L"flac", L"aac",
+
+    // fonts
+    L"woff", L"woff2",
+    L"eot", L"ttf", L"otf",
+};
+
+static bool IsWordChar(wchar_t c)
+{
+    return (c >= L'a' && c <= L'z') || (c >= L'A' && c <= L'Z')
+        || (c >= L'0' && c <= L'9') || c == L'_';
+}
+
+static bool EqualN(const wchar_t *s, size_t n, const wchar_t *lit)
+{
+    return wcslen(lit) == n && wcsncmp(s, lit, n) == 0;
+}
+
+// Same as /^https:\/\/plugins.*\.js(?:\?.*)?$/
+static bool IsPluginModuleURL(const wchar_t *url, size_t length)
+{
+    static const wchar_t prefix[] = L"https://plugins";
+    const size_t prefix_length = COUNT_OF(prefix) - 1;
+
+    if (length < prefix_length || wcsncmp(url, prefix, prefix_length) != 0)
+        return false;
+
+    for (size_t i = prefix_length; i <= length; i++)
+    {
+        // Any '?' or the end, preceded by .js
+        if ((i == length || url[i] == L'?') && i >= prefix_length + 3
+            && wcsncmp(url + i - 3, L".js", 3) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+// Same as /\bword\b/
+static bool HasQueryWord(const wchar_t *query, size_t length, const wchar_t *word)
+{
+    size_t n = wcslen(word);
+
+    for (size_t i = 0; i + n <= length; i++)
+    {
+        if (wcsncmp(query + i, word, n) == 0
+            && (i == 0 || !IsWordChar(query[i - 1]))
+            && (i + n == length || !IsWordChar(query[i + n])))
+            return true;
+    }
+
+    return false;
+}
+
+// Classify import by referrer, query flags and file extension, in one pass without allocation.
+assets::ImportType assets::classifyImport(const wchar_t *referrer, size_t referrer_length,
+    const wchar_t *query, size_t query_length, const wchar_t *path, size_t path_length)
+{
+    // Detect relative plugin imports by referer //plugins.
+    if (!IsPluginModuleURL(referrer, referrer_length))
+        return IMPORT_DEFAULT;
+
+    if (HasQueryWord(query, query_length, L"url"))
+        return IMPORT_URL;
+    if (HasQueryWord(query, query_length, L"raw"))
+        return IMPORT_RAW;
+
+    size_t pos = path_length;
+    while (pos > 0 && path[pos - 1] != L'.')
+        pos--;
+    if (pos == 0)
+        return IMPORT_DEFAULT;
+
+    const wchar_t *ext = path + pos;
+    size_t ext_length = path_length - pos;
+
+    if (EqualN(ext, ext_length, L"css"))
+        return IMPORT_CSS;
+    if (EqualN(ext, ext_length, L"json"))
+        return IMPORT_JSON;
+
+    for (auto known : known_assets)
+        if (EqualN(ext, ext_length, known))
+            return IMPORT_URL;
+
+    return IMPORT_DEFAULT;
+}
\ No newline at end of file
@@ -0,0 +1,217 @@
+#include "../internal.h"
+#include <map>
+#include <mutex>
+
+// BROWSER PROCESS ONLY.
+
+// Latency buckets by power of two in microseconds, last one is open ended.
+static const int HISTOGRAM_BUCKETS = 24;
+// Same order as ImportType in assets.cc.
+static const char *IMPORT_NAMES[] = { "default", "css", "json", "raw", "url" };
+static const char *ROUTE_NAMES[] = { "assets", "plugins", "riotclient" };
+
+static const int TYPE_COUNT = COUNT_OF(IMPORT_NAMES);
+
+void GetAssetCacheStats(int64 &hits, int64 &misses, int64 &evictions, int64 &bytes);
+void GetAssetsOpenStats(int64 &pending, int64 &peak, int64 &inline_opens);
+void GetPreloadStats(int64 &walks, int64 &modules);
+int64 GetAssetsReadAllocs();
+
+struct Histogram
+{
+    std::atomic<int64> count;
+    std::atomic<int64> sum;
+    std::atomic<int64> buckets[HISTOGRAM_BUCKETS];
+
+    void Add(int64 micros)
+    {
+        int bucket = 0;
+        for (int64 v = micros; v > 1 && bucket < HISTOGRAM_BUCKETS - 1; v >>= 1)
+            bucket++;
+
+        ++count;
+        sum += micros;
+        ++buckets[bucket];
+    }
+};
+
+struct RouteMetrics
+{
+    std::atomic<int64> requests;
+    std::atomic<int64> not_found;
+    std::atomic<int64> not_modified;
+    std::atomic<int64> cache_hits;
+    std::atomic<int64> bytes;
+    Histogram open;
+    Histogram first_byte;
+};
+
+// Zero initialized as static storage, only atomics inside.
+static RouteMetrics metrics_[metrics::ROUTE_COUNT][TYPE_COUNT];
+
+struct PluginLoad
+{
+    int64 loads;
+    int64 failures;
+    int64 last_us;
+    int64 max_us;
+    string error;   // of last failure
+};
+
+// Keyed by plugin name, few entries and reported once per page load.
+static std::mutex plugins_mutex_;
+static std::map<string, PluginLoad> plugins_;
+
+static RouteMetrics *GetMetrics(metrics::Route route, int type)
+{
+    if (route < 0 || route >= metrics::ROUTE_COUNT || type < 0 || type >= TYPE_COUNT)
+        return nullptr;
+
+    return &metrics_[route][type];
+}
+
+void metrics::recordOpen(Route route, int type, int status, int64 micros, bool cache_hit)
+{
+    if (auto m = GetMetrics(route, type))
+    {
+        ++m->requests;
+        if (status == 404) ++m->not_found;
+        if (status == 304) ++m->not_modified;
+        if (cache_hit) ++m->cache_hits;
+        m->open.Add(micros);
+    }
+}
+
+void metrics::recordFirstByte(Route route, int type, int64 micros)
+{
+    if (auto m = GetMetrics(route, type))
+        m->first_byte.Add(micros);
+}
+
+void metrics::recordBytes(Route route, int type, int64 bytes)
+{
+    if (auto m = GetMetrics(route, type))
+        m->bytes += bytes;
+}
+
+void metrics::recordPluginLoad(const wstring &name, bool ok, int64 micros, const wstring &error)
+{
+    std::lock_guard<std::mutex> lock(plugins_mutex_);
+    auto &load = plugins_[utils::toNarrow(name)];
+
+    ++load.loads;
+    load.last_us = micros;
+    if (micros > load.max_us) load.max_us = micros;
+
+    if (!ok)
+    {
+        ++load.failures;
+        load.error = utils::toNarrow(error);
+    }
+}
+
+static void AppendPlugins(string &out)
+{
+    char buf[160];
+    std::lock_guard<std::mutex> lock(plugins_mutex_);
+
+    out.append("\"plugins\":{");
+
+    for (auto it = plugins_.begin(); it != plugins_.end(); ++it)
+    {
+        const auto &load = it->second;
+
+        if (it != plugins_.begin())
+            out.push_back(',');
+
+        utils::appendJsonString(out, it->first);
+        snprintf(buf, sizeof(buf), ":{\"loads\":%lld,\"failures\":%lld,\"last_us\":%lld,\"max_us\":%lld,\"error\":",
+            load.loads, load.failures, load.last_us, load.max_us);
+        out.append(buf);
+
+        if (load.failures == 0)
+            out.append("null");
+        else
+            utils::appendJsonString(out, load.error);
+
+        out.push_back('}');
+    }
+
+    out.push_back('}');
+}
+
+static void AppendHistogram(string &out, const char *name, const Histogram &h)
+{
+    char buf[64];
+
+    snprintf(buf, sizeof(buf), "\"%s\":{\"count\":%lld,\"sum\":%lld,\"buckets\":[",
+        name, h.count.load(), h.sum.load());
+    out.append(buf);
+
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++)
+    {
+        snprintf(buf, sizeof(buf), i ? ",%lld" : "%lld", h.buckets[i].load());
+        out.append(buf);
+    }
+
+    out.append("]}");
+}
+
+// Counters and histograms as JSON, routes/types with no request are left out.
+string metrics::dumpJson()
+{
+    char buf[256];
+    string out = "{\"routes\":{";
+
+    for (int route = 0; route < ROUTE_COUNT; route++)
+    {
+        bool first = true;
+
+        out.append(route ? ",\"" : "\"").append(ROUTE_NAMES[route]).append("\":{");
+
+        for (int type = 0; type < TYPE_COUNT; type++)
+        {
+            const auto &m = metrics_[route][type];
+            if (m.requests == 0)
+                continue;
+
+            snprintf(buf, sizeof(buf), "%s\"%s\":{\"requests\":%lld,\"not_found\":%lld,"
+                "\"not_modified\":%lld,\"cache_hits\":%lld,\"bytes\":%lld,",
+                first ? "" : ",", IMPORT_NAMES[type], m.requests.load(), m.not_found.load(),
+                m.not_modified.load(), m.cache_hits.load(), m.bytes.load());
+            out.append(buf);
+
+            AppendHistogram(out, "open_us", m.open);
+            out.push_back(',');
+            AppendHistogram(out, "first_byte_us", m.first_byte);
+            out.push_back('}');
+
+            first = false;
+        }
+
+        out.push_back('}');
+    }
+
+    int64 hits, misses, evictions, bytes;
+    GetAssetCacheStats(hits, misses, evictions, bytes);
+
+    int64 pending, peak, inline_opens;
+    GetAssetsOpenStats(pending, peak, inline_opens);
+
+    int64 walks, walked;
+    GetPreloadStats(walks, walked);
+
+    snprintf(buf, sizeof(buf), "},\"cache\":{\"hits\":%lld,\"misses\":%lld,\"evictions\":%lld,\"bytes\":%lld}"
+        ",\"opens\":{\"pending\":%lld,\"peak\":%lld,\"inline\":%lld},",
+        hits, misses, evictions, bytes, pending, peak, inline_opens);
+    out.append(buf);
+
+    snprintf(buf, sizeof(buf), "\"preload\":{\"walks\":%lld,\"modules\":%lld},\"read_allocs\":%lld,",
+        walks, walked, GetAssetsReadAllocs());
+    out.append(buf);
+
+    AppendPlugins(out);
+    out.push_back('}');
+
+    return out;
+}
\ No newline at end of file
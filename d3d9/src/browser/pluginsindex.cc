@@ -0,0 +1,165 @@
+#include "../common.h"
+#include <cwctype>
+
+// BROWSER PROCESS ONLY.
+
+void PluginsIndex::Add(const wstring &path, bool dir)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    map_[MakeKey(path)] = PluginsIndexEntry{ Normalize(path), dir, nullptr, nullptr, 0, false, L"" };
+}
+
+void PluginsIndex::AddPacked(const wstring &path, const std::shared_ptr<PluginPack> &pack, const char *data, size_t size)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    map_[MakeKey(path)] = PluginsIndexEntry{ Normalize(path), false, pack, data, size, false, L"" };
+}
+
+void PluginsIndex::Remove(const wstring &path)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto key = MakeKey(path);
+    auto prefix = key + L"/";
+    map_.erase(key);
+
+    // Drop children of removed folder.
+    for (auto it = map_.begin(); it != map_.end();)
+    {
+        if (it->first.compare(0, prefix.length(), prefix) == 0)
+            it = map_.erase(it);
+        else
+            ++it;
+    }
+}
+
+void PluginsIndex::Swap(PluginsIndex &other)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<std::mutex> lock2(other.mutex_);
+    map_.swap(other.map_);
+    modules_epoch_++;
+}
+
+bool PluginsIndex::Resolve(const wstring &request, wstring &resolved, bool &js)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    return ResolveWith(request, resolved, js, [this](const wstring &key, bool &dir, wstring &path)
+    {
+        auto it = map_.find(key);
+        if (it == map_.end())
+            return false;
+
+        dir = it->second.dir;
+        if (!dir) path = it->second.path;
+        return true;
+    });
+}
+
+bool PluginsIndex::IsDir(const wstring &path)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = map_.find(MakeKey(path));
+    return it != map_.end() && it->second.dir;
+}
+
+bool PluginsIndex::GetPacked(const wstring &path, std::shared_ptr<PluginPack> &pack, const char *&data, size_t &size)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = map_.find(MakeKey(path));
+    if (it == map_.end() || it->second.pack == nullptr)
+        return false;
+
+    pack = it->second.pack;
+    data = it->second.data;
+    size = it->second.size;
+    return true;
+}
+
+bool PluginsIndex::GetModule(const wstring &dir, wstring &module, uint64_t &epoch)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    epoch = modules_epoch_;
+
+    auto it = map_.find(MakeKey(dir));
+    if (it == map_.end() || !it->second.has_module)
+        return false;
+
+    module = it->second.module;
+    return true;
+}
+
+void PluginsIndex::SetModule(const wstring &dir, const wstring &module, uint64_t epoch)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = map_.find(MakeKey(dir));
+    if (it == map_.end() || !it->second.dir || epoch != modules_epoch_)
+        return;
+
+    it->second.has_module = true;
+    it->second.module = module;
+}
+
+void PluginsIndex::ClearModules(const wstring &path)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    modules_epoch_++;
+
+    for (auto key = MakeKey(path); !key.empty();)
+    {
+        auto it = map_.find(key);
+        if (it != map_.end())
+        {
+            it->second.has_module = false;
+            it->second.module.clear();
+        }
+
+        size_t slash = key.find_last_of(L'/');
+        key.erase(slash == wstring::npos ? 0 : slash);
+    }
+}
+
+wstring PluginsIndex::Normalize(const wstring &path)
+{
+    wstring out{};
+    size_t start = 0;
+
+    while (start <= path.length())
+    {
+        size_t end = path.find_first_of(L"/\\", start);
+        if (end == wstring::npos) end = path.length();
+
+        auto part = path.substr(start, end - start);
+        start = end + 1;
+
+        if (part.empty() || part == L".")
+            continue;
+
+        if (part == L"..")
+        {
+            size_t pos = out.find_last_of(L'\\');
+            out.erase(pos == wstring::npos ? 0 : pos);
+            continue;
+        }
+
+        if (!out.empty()) out.push_back(L'\\');
+        out.append(part);
+    }
+
+    return out;
+}
+
+wstring PluginsIndex::MakeKey(const wstring &path)
+{
+    auto key = Normalize(path);
+    for (auto &c : key)
+        c = c == L'\\' ? L'/' : towlower(c);
+    return key;
+}
+
+wstring PluginsIndex::Join(const wstring &key, const wchar_t *name)
+{
+    return key.empty() ? name : key + L"/" + name;
+}
\ No newline at end of file
@@ -0,0 +1,268 @@
+#include "../internal.h"
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+// BROWSER PROCESS ONLY.
+
+// Chromium discovers nested imports only after each module is parsed,
+// walk the graph ahead of it so every module is in memory when asked.
+
+static const size_t PRELOAD_THREADS = 4;
+static const size_t MAX_PENDING_PRELOADS = 256;
+static const size_t MAX_PRELOAD_MODULES = 1024;
+
+bool ResolvePluginPath(const wstring &request, wstring &path, bool &js);
+bool LoadAssetContent(const wstring &path, int64 &mtime,
+    std::shared_ptr<const void> &owner, const char *&data, int64 &length);
+
+struct ModuleImports
+{
+    int64 length;
+    int64 mtime;
+    vector<string> specifiers;
+};
+
+// Scanned imports by full path, rescanned when file changes.
+static std::mutex graph_mutex_;
+static std::unordered_map<wstring, ModuleImports> graph_;
+
+// For metrics, walks started and modules visited by them.
+static std::atomic<int64> walks_{ 0 };
+static std::atomic<int64> walked_modules_{ 0 };
+
+// One walk from an entry module.
+struct PreloadSession
+{
+    std::mutex mutex;
+    std::unordered_set<wstring> visited;
+};
+
+static utils::WorkerPool &GetPreloadPool()
+{
+    static auto pool = new utils::WorkerPool(PRELOAD_THREADS, MAX_PENDING_PRELOADS);
+    return *pool;
+}
+
+static bool IsIdentChar(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')
+        || (c >= '0' && c <= '9') || c == '_' || c == '$';
+}
+
+static size_t SkipSpaces(const char *s, size_t n, size_t i)
+{
+    while (i < n)
+    {
+        if (s[i] == ' ' || s[i] == '\t' || s[i] == '\r' || s[i] == '\n')
+            i++;
+        else if (i + 1 < n && s[i] == '/' && s[i + 1] == '/')
+            while (i < n && s[i] != '\n') i++;
+        else if (i + 1 < n && s[i] == '/' && s[i + 1] == '*')
+        {
+            for (i += 2; i + 1 < n && !(s[i] == '*' && s[i + 1] == '/'); i++);
+            i = std::min(i + 2, n);
+        }
+        else
+            break;
+    }
+
+    return i;
+}
+
+static bool IsKeyword(const char *s, size_t n, size_t i, const char *word)
+{
+    size_t len = strlen(word);
+    return i + len <= n && memcmp(s + i, word, len) == 0
+        && (i == 0 || (!IsIdentChar(s[i - 1]) && s[i - 1] != '.'))
+        && (i + len == n || !IsIdentChar(s[i + len]));
+}
+
+// Read string literal at i, returns position after it.
+static size_t ReadString(const char *s, size_t n, size_t i, string *out)
+{
+    char quote = s[i++];
+
+    while (i < n && s[i] != quote)
+    {
+        if (s[i] == '\\') i++;
+        else if (s[i] == '\n' && quote != '`') break;
+        else if (out != nullptr) out->push_back(s[i]);
+        i++;
+    }
+
+    return i + 1;
+}
+
+// Collect specifiers of static and literal dynamic imports,
+//   import x from '...', import '...', export { x } from '...', import('...')
+static void ScanImports(const char *s, size_t n, vector<string> &out)
+{
+    for (size_t i = 0; i < n;)
+    {
+        char c = s[i];
+
+        if (c == '"' || c == '\'' || c == '`')
+        {
+            i = ReadString(s, n, i, nullptr);
+            continue;
+        }
+
+        if (c == '/' && i + 1 < n && (s[i + 1] == '/' || s[i + 1] == '*'))
+        {
+            i = SkipSpaces(s, n, i);
+            continue;
+        }
+
+        bool is_import = IsKeyword(s, n, i, "import");
+        if (!is_import && !IsKeyword(s, n, i, "export"))
+        {
+            i++;
+            continue;
+        }
+
+        size_t j = SkipSpaces(s, n, i + 6);
+        i += 6;
+
+        // import '...' or import('...')
+        if (is_import && j < n && s[j] == '(')
+            j = SkipSpaces(s, n, j + 1);
+        if (is_import && j < n && (s[j] == '"' || s[j] == '\''))
+        {
+            string spec{};
+            i = ReadString(s, n, j, &spec);
+            out.push_back(spec);
+            continue;
+        }
+
+        // Find "from '...'" before the statement ends.
+        for (size_t k = j; k < n && k < j + 1024; k++)
+        {
+            char d = s[k];
+            if (d == ';' || d == '(' || d == '=' || d == '"' || d == '\'' || d == '`')
+                break;
+
+            if (IsKeyword(s, n, k, "from"))
+            {
+                size_t q = SkipSpaces(s, n, k + 4);
+                if (q < n && (s[q] == '"' || s[q] == '\''))
+                {
+                    string spec{};
+                    i = ReadString(s, n, q, &spec);
+                    out.push_back(spec);
+                }
+                break;
+            }
+        }
+    }
+}
+
+// Resolve specifier against importer request path, only plugin files count.
+static bool ResolveSpecifier(const wstring &importer, const string &spec, wstring &request)
+{
+    static const char origin[] = "https://plugins/";
+    const size_t origin_length = COUNT_OF(origin) - 1;
+
+    auto target = spec.substr(0, spec.find_first_of("?#"));
+
+    if (target.empty())
+        return false;
+    if (target.compare(0, origin_length, origin) == 0)
+        request = utils::toWide(target.substr(origin_length - 1));
+    else if (target[0] == '/')
+        request = utils::toWide(target);
+    else if (target.compare(0, 2, "./") == 0 || target.compare(0, 3, "../") == 0)
+        request = importer.substr(0, importer.find_last_of(L'/') + 1) + utils::toWide(target);
+    else
+        return false;
+
+    return true;
+}
+
+static void PreloadModule(const std::shared_ptr<PreloadSession> &session, const wstring &request);
+
+static void PreloadImports(const std::shared_ptr<PreloadSession> &session,
+    const wstring &importer, const vector<string> &specifiers)
+{
+    for (const auto &spec : specifiers)
+    {
+        wstring request{};
+        if (!ResolveSpecifier(importer, spec, request))
+            continue;
+
+        bool posted = GetPreloadPool().post([session, request] { PreloadModule(session, request); });
+        if (!posted) PreloadModule(session, request);
+    }
+}
+
+static void PreloadModule(const std::shared_ptr<PreloadSession> &session, const wstring &request)
+{
+    wstring path{};
+    bool js = false;
+
+    if (!ResolvePluginPath(request, path, js))
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(session->mutex);
+        if (session->visited.size() >= MAX_PRELOAD_MODULES || !session->visited.insert(path).second)
+            return;
+    }
+
+    ++walked_modules_;
+
+    // Loading it warms the assets cache.
+    std::shared_ptr<const void> owner;
+    const char *data;
+    int64 length, mtime;
+
+    if (!LoadAssetContent(path, mtime, owner, data, length))
+        return;
+
+    if (!js && !utils::strEndWith(path, L".js") && !utils::strEndWith(path, L".mjs"))
+        return;
+
+    vector<string> specifiers{};
+    bool scanned = false;
+
+    {
+        std::lock_guard<std::mutex> lock(graph_mutex_);
+        auto it = graph_.find(path);
+        if (it != graph_.end() && it->second.length == length && it->second.mtime == mtime)
+        {
+            specifiers = it->second.specifiers;
+            scanned = true;
+        }
+    }
+
+    if (!scanned)
+    {
+        ScanImports(data, static_cast<size_t>(length), specifiers);
+
+        std::lock_guard<std::mutex> lock(graph_mutex_);
+        graph_[path] = ModuleImports{ length, mtime, specifiers };
+    }
+
+    // Request paths are '/' separated like URLs.
+    wstring importer = request;
+    for (auto &c : importer)
+        if (c == L'\\') c = L'/';
+
+    PreloadImports(session, importer, specifiers);
+}
+
+// Warm up the import graph of plugin entry module in background.
+void PreloadPluginModules(const wstring &request)
+{
+    auto session = std::make_shared<PreloadSession>();
+
+    ++walks_;
+    GetPreloadPool().post([session, request] { PreloadModule(session, request); });
+}
+
+void GetPreloadStats(int64 &walks, int64 &modules)
+{
+    walks = walks_;
+    modules = walked_modules_;
+}
\ No newline at end of file
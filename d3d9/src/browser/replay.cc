@@ -0,0 +1,95 @@
+#include "../internal.h"
+#include <fstream>
+#include <mutex>
+
+// Recording of assets trace and rundll32 entry to replay it,
+// format and replay are in browser/assetstrace.cc.
+
+static const int DEFAULT_REPLAY_ITERATIONS = 20;
+
+static std::once_flag trace_init_;
+static std::mutex trace_mutex_;
+static std::ofstream *trace_ = nullptr;
+
+// Enabled by RecordAssetsTrace=1, written to assets.trace in loader folder.
+bool IsAssetsTraceEnabled()
+{
+    std::call_once(trace_init_, []
+    {
+        if (config::getConfigValue(L"RecordAssetsTrace") == L"1")
+            trace_ = new std::ofstream(config::getLoaderDir() + L"\\assets.trace", std::ios::binary | std::ios::app);
+    });
+
+    return trace_ != nullptr;
+}
+
+static wstring GetRelativePath(const wstring &path, bool plugin)
+{
+    auto root = plugin ? config::getPluginsDir() : config::getAssetsDir();
+    if (path.length() < root.length() || _wcsnicmp(path.c_str(), root.c_str(), root.length()) != 0)
+        return path;
+
+    return path.substr(root.length());
+}
+
+void TraceAssetRequest(const assets::Request &request, const assets::Response &response)
+{
+    auto line = assets::formatTrace(request, response, GetRelativePath(response.path, request.plugin));
+
+    std::lock_guard<std::mutex> lock(trace_mutex_);
+    trace_->write(line.data(), line.length());
+    trace_->flush();
+}
+
+// Entry for rundll32: replay <trace> [iterations] [disk].
+// Serves the trace off a synthetic tree, or live folders with "disk".
+int APIENTRY _ReplayAssetsEntry(HWND hwnd, HINSTANCE instance, LPWSTR commandLine, int showFlag)
+{
+    int argc;
+    LPWSTR *argv = CommandLineToArgvW(commandLine, &argc);
+
+    if (argv == NULL || argc < 1)
+        return 1;
+
+    wstring file = argv[0];
+    int iterations = argc > 1 ? _wtoi(argv[1]) : DEFAULT_REPLAY_ITERATIONS;
+    bool disk = argc > 2 && _wcsicmp(argv[2], L"disk") == 0;
+    LocalFree(argv);
+
+    string content{};
+    vector<std::unique_ptr<assets::TraceRecord>> records{};
+
+    if (utils::readFile(file, content))
+        assets::parseTrace(content, records);
+
+    if (records.empty() || iterations <= 0)
+    {
+        MessageBoxW(hwnd, (L"Failed to read assets trace: " + file).c_str(),
+            L"League Loader", MB_OK | MB_ICONWARNING);
+        return 1;
+    }
+
+    assets::SyntheticSource synthetic{};
+    for (const auto &rec : records)
+        if (rec->status != 404) synthetic.add(rec->request.plugin, rec->path, rec->size, rec->mtime);
+
+#ifdef LL_ALLOC_STATS
+    int64 allocs = utils::allocCount();
+#endif
+
+    auto result = assets::replay(disk ? assets::diskSource() : synthetic, records, iterations);
+
+#ifdef LL_ALLOC_STATS
+    result.allocs = utils::allocCount() - allocs;
+#endif
+
+    auto report = assets::formatReplay(result, disk ? "disk" : "synthetic");
+
+    // Report next to trace, for scripts.
+    std::ofstream stream(file + L".replay.txt", std::ios::binary | std::ios::trunc);
+    stream.write(report.data(), report.length());
+    stream.close();
+
+    MessageBoxW(hwnd, utils::toWide(report).c_str(), L"League Loader", MB_OK | MB_ICONINFORMATION);
+    return 0;
+}
\ No newline at end of file
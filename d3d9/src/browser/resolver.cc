@@ -0,0 +1,297 @@
+#include "../internal.h"
+#include <cwctype>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+
+// BROWSER PROCESS ONLY.
+
+static PluginsIndex index_;
+static std::once_flag index_built_;
+
+static void ScanDir(PluginsIndex &index, const wstring &base, const wstring &rel)
+{
+    WIN32_FIND_DATAW fd;
+    HANDLE hFind = FindFirstFileW((base + L"\\" + rel + L"*").c_str(), &fd);
+
+    if (hFind == INVALID_HANDLE_VALUE)
+        return;
+
+    do
+    {
+        wstring name = fd.cFileName;
+        if (name == L"." || name == L"..")
+            continue;
+
+        bool dir = (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+        index.Add(rel + name, dir);
+
+        if (dir)
+            ScanDir(index, base, rel + name + L"\\");
+    } while (FindNextFileW(hFind, &fd));
+
+    FindClose(hFind);
+}
+
+static bool IsPackFile(const wstring &name)
+{
+    return name.length() > 5 && _wcsicmp(name.c_str() + name.length() - 5, L".llpk") == 0;
+}
+
+// Add entries of plugins/<name>.llpk as virtual files under <name>.
+static void ScanPack(PluginsIndex &index, const wstring &base, const wstring &file)
+{
+    auto name = file.substr(0, file.length() - 5);
+
+    // Unpacked folder takes precedence.
+    if (index.IsDir(name))
+        return;
+
+    auto pack = std::make_shared<PluginPack>();
+    int64 size;
+    vector<utils::PackEntry> entries{};
+
+    if (!utils::statFile(base + L"\\" + file, size, pack->mtime)
+        || !pack->file.open(base + L"\\" + file)
+        || !utils::readPack(pack->file.data(), pack->file.size(), entries))
+        return;
+
+    index.Add(name, true);
+
+    for (const auto &entry : entries)
+    {
+        auto path = name + L"\\" + PluginsIndex::Normalize(utils::toWide(entry.name));
+
+        // Packs have no folder entries.
+        for (size_t pos = name.length() + 1; (pos = path.find(L'\\', pos)) != wstring::npos; pos++)
+            index.Add(path.substr(0, pos), true);
+
+        index.AddPacked(path, pack, entry.data, entry.size);
+    }
+}
+
+static void BuildPluginsIndex()
+{
+    auto base = config::getPluginsDir();
+
+    {
+        // Swap at once, lookups never see a partial index.
+        PluginsIndex index{};
+        ScanDir(index, base, L"");
+
+        for (const auto &file : utils::readDir(base + L"\\*.llpk"))
+            if (IsPackFile(file)) ScanPack(index, base, file);
+
+        index_.Swap(index);
+    }
+
+    // Old packs moved aside by the packer, unmapped with the old index
+    // unless a response still reads them.
+    for (const auto &file : utils::readDir(base + L"\\*.llpk.*.old"))
+        DeleteFileW((base + L"\\" + file).c_str());
+}
+
+static void UpdatePluginsIndex(DWORD action, const wstring &path)
+{
+    // Edited package.json, or added/removed entry file.
+    if (_wcsnicmp(path.c_str(), L"_shared\\", 8) == 0)
+        index_.ClearModules(path);
+
+    // Packs and folders shadowing them are rare, just rescan.
+    if (IsPackFile(path) || (path.find(L'\\') == wstring::npos
+        && utils::fileExist(config::getPluginsDir() + L"\\" + path + L".llpk")))
+    {
+        BuildPluginsIndex();
+        return;
+    }
+
+    switch (action)
+    {
+        case FILE_ACTION_ADDED:
+        case FILE_ACTION_RENAMED_NEW_NAME:
+        {
+            auto full = config::getPluginsDir() + L"\\" + path;
+            if (utils::dirExist(full))
+            {
+                index_.Add(path, true);
+                // Moved-in folder brings its children.
+                ScanDir(index_, config::getPluginsDir(), PluginsIndex::Normalize(path) + L"\\");
+            }
+            else if (utils::fileExist(full))
+            {
+                index_.Add(path, false);
+            }
+            break;
+        }
+
+        case FILE_ACTION_REMOVED:
+        case FILE_ACTION_RENAMED_OLD_NAME:
+            index_.Remove(path);
+            break;
+    }
+}
+
+// Editors save in several steps, notify once they settle.
+static const DWORD RELOAD_DEBOUNCE_MS = 150;
+
+void NotifyPluginsChanged(const vector<wstring> &plugins);
+
+// Get plugin name of changed path, empty for non-plugin.
+static wstring GetChangedPlugin(const wstring &path)
+{
+    auto name = path.substr(0, path.find(L'\\'));
+
+    if (name.empty() || name[0] == L'_' || name[0] == L'.')
+        return L"";
+    if (IsPackFile(name))
+        name.resize(name.length() - 5);
+
+    return name;
+}
+
+static DWORD WINAPI PluginsWatcherThread(LPVOID)
+{
+    const DWORD filter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME
+        | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE;
+
+    HANDLE dir = CreateFileW(config::getPluginsDir().c_str(), FILE_LIST_DIRECTORY,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING,
+        FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+
+    DWORD buffer[16 * 1024];
+    OVERLAPPED ov{};
+    ov.hEvent = CreateEventW(NULL, FALSE, FALSE, NULL);
+
+    // Start watching before scanning, so nothing is missed in between.
+    bool watching = dir != INVALID_HANDLE_VALUE
+        && ReadDirectoryChangesW(dir, buffer, sizeof(buffer), TRUE, filter, NULL, &ov, NULL);
+
+    std::call_once(index_built_, BuildPluginsIndex);
+
+    std::set<wstring> changed{};
+
+    while (watching)
+    {
+        if (WaitForSingleObject(ov.hEvent, changed.empty() ? INFINITE : RELOAD_DEBOUNCE_MS) == WAIT_TIMEOUT)
+        {
+            NotifyPluginsChanged(vector<wstring>(changed.begin(), changed.end()));
+            changed.clear();
+            continue;
+        }
+
+        DWORD bytes = 0;
+        if (!GetOverlappedResult(dir, &ov, &bytes, FALSE))
+            break;
+
+        vector<std::pair<DWORD, wstring>> changes{};
+        bool overflow = (bytes == 0);
+
+        for (auto info = reinterpret_cast<FILE_NOTIFY_INFORMATION *>(buffer); !overflow;)
+        {
+            changes.emplace_back(info->Action,
+                wstring(info->FileName, info->FileNameLength / sizeof(WCHAR)));
+
+            if (info->NextEntryOffset == 0) break;
+            info = reinterpret_cast<FILE_NOTIFY_INFORMATION *>(
+                reinterpret_cast<char *>(info) + info->NextEntryOffset);
+        }
+
+        // Re-arm before processing.
+        watching = ReadDirectoryChangesW(dir, buffer, sizeof(buffer), TRUE, filter, NULL, &ov, NULL) != FALSE;
+
+        if (overflow)
+        {
+            // Too many changes, rescan all.
+            BuildPluginsIndex();
+
+            for (const auto &name : utils::readDir(config::getPluginsDir() + L"\\*"))
+                changes.emplace_back(0, name);
+        }
+        else
+        {
+            for (const auto &change : changes)
+                UpdatePluginsIndex(change.first, change.second);
+        }
+
+        for (const auto &change : changes)
+        {
+            auto name = GetChangedPlugin(change.second);
+            if (!name.empty()) changed.insert(name);
+        }
+    }
+
+    if (dir != INVALID_HANDLE_VALUE)
+        CloseHandle(dir);
+    CloseHandle(ov.hEvent);
+
+    return 0;
+}
+
+void PreparePluginsIndex()
+{
+    CreateThread(NULL, 0, PluginsWatcherThread, NULL, 0, NULL);
+}
+
+// Path under _shared, where folders resolve by their package.json, e.g. _shared\preact\hooks.
+static wstring GetSharedPackage(const wstring &request)
+{
+    auto path = PluginsIndex::Normalize(request);
+    if (path.length() <= 8 || _wcsnicmp(path.c_str(), L"_shared\\", 8) != 0)
+        return L"";
+
+    return path;
+}
+
+// Resolve /plugins request path to full file path.
+bool ResolvePluginPath(const wstring &request, wstring &path, bool &js)
+{
+    // Wait for initial scan.
+    std::call_once(index_built_, BuildPluginsIndex);
+
+    wstring resolved{};
+    auto shared = GetSharedPackage(request);
+
+    // Shared library folder goes to its package.json entry, same as import map.
+    // Entry is kept in index until the watcher sees a change below the folder.
+    if (!shared.empty() && index_.IsDir(shared))
+    {
+        wstring entry{};
+        uint64_t epoch;
+
+        if (!index_.GetModule(shared, entry, epoch))
+        {
+            entry = utils::getPackageEntry(config::getPluginsDir() + L"\\" + shared);
+            index_.SetModule(shared, entry, epoch);
+        }
+
+        if (!entry.empty() && index_.Resolve(shared + L"\\" + entry, resolved, js))
+        {
+            path = config::getPluginsDir() + L"\\" + resolved;
+            return true;
+        }
+    }
+
+    if (!index_.Resolve(request, resolved, js))
+        return false;
+
+    path = config::getPluginsDir() + L"\\" + resolved;
+    return true;
+}
+
+// Get packed plugin file by full path.
+bool GetPackedPluginFile(const wstring &path, std::shared_ptr<const void> &owner, const char *&data, size_t &size, int64 &mtime)
+{
+    auto base = config::getPluginsDir();
+    if (path.length() <= base.length() || _wcsnicmp(path.c_str(), base.c_str(), base.length()) != 0)
+        return false;
+
+    std::call_once(index_built_, BuildPluginsIndex);
+
+    std::shared_ptr<PluginPack> pack;
+    if (!index_.GetPacked(path.substr(base.length()), pack, data, size))
+        return false;
+
+    mtime = pack->mtime;
+    owner = pack;
+    return true;
+}
\ No newline at end of file
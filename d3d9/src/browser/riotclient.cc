@@ -71,6 +71,7 @@ struct RiotClientResourceHandler : CefRefCount<cef_resource_handler_t>
 {
     RiotClientResourceHandler(cef_frame_t *frame, const wstring &path)
         : CefRefCount(this), frame_(frame), path_(path), bytes_read_(0), client_(nullptr), data_{}
+        , start_(0)
     {
         cef_resource_handler_t::open = _open;
         cef_resource_handler_t::process_request = _process_request;
@@ -88,6 +89,7 @@ private:
     string data_;
     wstring path_;
     int64 bytes_read_;
+    int64 start_;
 
     static int CEF_CALLBACK _open(cef_resource_handler_t *_,
         struct _cef_request_t* request, int* handle_request, struct _cef_callback_t* callback)
@@ -100,6 +102,7 @@ private:
         struct _cef_request_t* request, struct _cef_callback_t* callback)
     {
         auto self = static_cast<RiotClientResourceHandler *>(_);
+        self->start_ = utils::tickMicros();
 
         CefStr url{ m_rcOrigin + self->path_ };
         CefScopedStr method{ request->get_method(request) };
@@ -122,10 +125,11 @@ private:
         struct _cef_response_t* response, int64* response_length, cef_string_t* redirectUrl)
     {
         auto self = static_cast<RiotClientResourceHandler *>(_);
+        int status = 0;
 
         if (auto res = self->url_request_->get_response(self->url_request_))
         {
-            auto status = res->get_status(res);
+            status = res->get_status(res);
             auto error = res->get_error(res);
             auto headers = CefStringMultimap_Alloc();
             res->get_header_map(res, headers);
@@ -138,6 +142,8 @@ private:
 
         response->set_header_by_name(response, &"Access-Control-Allow-Origin"_s, &"*"_s, 1);
         *response_length = self->client_->response_length_;
+
+        metrics::recordOpen(metrics::ROUTE_RIOTCLIENT, 0, status, utils::tickMicros() - self->start_, false);
     }
 
     bool Read(void *data_out, int bytes_to_read, int &bytes_read, cef_resource_read_callback_t *callback)
@@ -152,6 +158,10 @@ private:
         int read = std::min(bytes_to_read, static_cast<int>(data_.length() - bytes_read_));
         memcpy(data_out, data_.c_str() + bytes_read_, read);
 
+        if (bytes_read_ == 0 && read > 0)
+            metrics::recordFirstByte(metrics::ROUTE_RIOTCLIENT, 0, utils::tickMicros() - start_);
+        metrics::recordBytes(metrics::ROUTE_RIOTCLIENT, 0, read);
+
         bytes_read_ += read;
         bytes_read = read;
         return true;
@@ -0,0 +1,466 @@
+#include "../common.h"
+#include <string.h>
+#include <wchar.h>
+#include <algorithm>
+#include <cwctype>
+
+// BROWSER PROCESS ONLY.
+
+// assets::serve and the HTTP parts of it, validators, ranges and fingerprints.
+// Platform-neutral, file access goes through Source, see browser/assets.cc.
+
+static const char SCRIPT_IMPORT_CSS[] = u8R"(
+(async function () {
+    if (document.readyState !== 'complete')
+        await new Promise(res => window.addEventListener('load', res));
+
+    const url = import.meta.url.replace(/\?.*$/, '');
+    const link = document.createElement('link');
+    link.setAttribute('rel', 'stylesheet');
+    link.setAttribute('href', url);
+
+    document.body.appendChild(link);
+})();
+)";
+
+static const char SCRIPT_IMPORT_URL[] = u8R"(
+const url = import.meta.url.replace(/\?.*$/, '');
+export default url;
+)";
+
+// Wrapper scripts are served straight from static storage.
+static const struct { const char *data; size_t size; } module_scripts[] =
+{
+    { nullptr, 0 },
+    { SCRIPT_IMPORT_CSS, sizeof(SCRIPT_IMPORT_CSS) - 1 },
+    { nullptr, 0 },     // IMPORT_JSON, inlined
+    { nullptr, 0 },     // IMPORT_RAW, inlined
+    { SCRIPT_IMPORT_URL, sizeof(SCRIPT_IMPORT_URL) - 1 },
+};
+
+// Append UTF-8 content as JS string literal body.
+static void AppendJsString(string &out, const char *data, size_t length)
+{
+    static const char HEX[] = "0123456789abcdef";
+
+    for (size_t i = 0; i < length; i++)
+    {
+        unsigned char c = static_cast<unsigned char>(data[i]);
+
+        switch (c)
+        {
+            case '"': out.append("\\\""); break;
+            case '\\': out.append("\\\\"); break;
+            case '\n': out.append("\\n"); break;
+            case '\r': out.append("\\r"); break;
+            case '\t': out.append("\\t"); break;
+            default:
+                if (c < 0x20)
+                {
+                    out.append("\\x");
+                    out.push_back(HEX[c >> 4]);
+                    out.push_back(HEX[c & 15]);
+                }
+                else
+                {
+                    out.push_back(static_cast<char>(c));
+                }
+        }
+    }
+}
+
+// JSON/raw module with file content embedded, no extra read in renderer.
+static bool CreateInlineModule(assets::Source &source, const wstring &path, int64 size, int64 mtime, bool json,
+    std::shared_ptr<const void> &owner, const char *&data, int64 &length)
+{
+    std::shared_ptr<const void> file;
+    const char *content;
+    int64 content_length;
+
+    if (!source.open(path, size, mtime, file, content, content_length, nullptr))
+        return false;
+
+    auto module = std::make_shared<string>();
+    module->reserve(static_cast<size_t>(content_length + content_length / 8 + 64));
+    module->append(json ? "export default JSON.parse(\"" : "export default \"");
+    AppendJsString(*module, content, static_cast<size_t>(content_length));
+    module->append(json ? "\");\n" : "\";\n");
+
+    data = module->c_str();
+    length = static_cast<int64>(module->length());
+    owner = module;
+    return true;
+}
+
+static const wchar_t *HTTP_DAYS[] = { L"Sun", L"Mon", L"Tue", L"Wed", L"Thu", L"Fri", L"Sat" };
+static const wchar_t *HTTP_MONTHS[] = { L"Jan", L"Feb", L"Mar", L"Apr", L"May", L"Jun",
+    L"Jul", L"Aug", L"Sep", L"Oct", L"Nov", L"Dec" };
+
+// FILETIME ticks are 100 ns since 1601-01-01.
+static const int64 TICKS_PER_SECOND = 10000000;
+static const int64 SECONDS_1601_TO_1970 = 11644473600LL;
+static const int64 SECONDS_PER_DAY = 86400;
+
+// Days since 1970-01-01 of proleptic Gregorian date, month 1-12.
+static int64 DaysFromCivil(int64 year, int month, int day)
+{
+    year -= month <= 2;
+    int64 era = (year >= 0 ? year : year - 399) / 400;
+    int64 yoe = year - era * 400;
+    int64 doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    int64 doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+static void CivilFromDays(int64 days, int64 &year, int &month, int &day)
+{
+    days += 719468;
+    int64 era = (days >= 0 ? days : days - 146096) / 146097;
+    int64 doe = days - era * 146097;
+    int64 yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int64 doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int64 mp = (5 * doy + 2) / 153;
+
+    day = static_cast<int>(doy - (153 * mp + 2) / 5 + 1);
+    month = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+    year = yoe + era * 400 + (month <= 2);
+}
+
+// Format FILETIME ticks to IMF-fixdate, e.g. "Sun, 06 Nov 1994 08:49:37 GMT".
+wstring assets::formatHttpDate(int64 time)
+{
+    if (time < 0)
+        return L"";
+
+    int64 seconds = time / TICKS_PER_SECOND - SECONDS_1601_TO_1970;
+    int64 days = seconds / SECONDS_PER_DAY - (seconds % SECONDS_PER_DAY < 0);
+    int64 rest = seconds - days * SECONDS_PER_DAY;
+
+    int64 year;
+    int month, day;
+    CivilFromDays(days, year, month, day);
+
+    if (year > 9999)
+        return L"";
+
+    // 1970-01-01 was Thursday.
+    int weekday = static_cast<int>((days % 7 + 11) % 7);
+
+    wchar_t buffer[32];
+    swprintf(buffer, COUNT_OF(buffer), L"%ls, %02d %ls %04d %02d:%02d:%02d GMT",
+        HTTP_DAYS[weekday], day, HTTP_MONTHS[month - 1], static_cast<int>(year),
+        static_cast<int>(rest / 3600), static_cast<int>(rest / 60 % 60), static_cast<int>(rest % 60));
+
+    return buffer;
+}
+
+// Parse IMF-fixdate to FILETIME ticks.
+bool assets::parseHttpDate(const wstring &date, int64 &time)
+{
+    wchar_t name[4]{};
+    int day, year, hour, minute, second, month = 0;
+
+    if (swscanf(date.c_str(), L"%*3ls, %d %3ls %d %d:%d:%d GMT",
+        &day, name, &year, &hour, &minute, &second) != 6)
+        return false;
+
+    for (int i = 0; i < 12; i++)
+        if (wcscmp(name, HTTP_MONTHS[i]) == 0)
+            month = i + 1;
+
+    if (month == 0 || year < 1601 || year > 9999 || day < 1 || day > 31
+        || hour < 0 || hour > 23 || minute < 0 || minute > 59 || second < 0 || second > 59)
+        return false;
+
+    // Day must exist in month, e.g. no Feb 30.
+    int64 days = DaysFromCivil(year, month, day);
+    int64 check_year;
+    int check_month, check_day;
+    CivilFromDays(days, check_year, check_month, check_day);
+
+    if (check_month != month || check_day != day)
+        return false;
+
+    int64 seconds = days * SECONDS_PER_DAY + hour * 3600 + minute * 60 + second;
+    time = (seconds + SECONDS_1601_TO_1970) * TICKS_PER_SECOND;
+    return true;
+}
+
+// Check If-None-Match list against our strong ETag.
+static bool MatchETag(const wstring &header, const wstring &etag)
+{
+    size_t start = 0;
+
+    while (start < header.length())
+    {
+        size_t end = header.find(L',', start);
+        if (end == wstring::npos) end = header.length();
+
+        size_t first = header.find_first_not_of(L" \t", start);
+        size_t last = header.find_last_not_of(L" \t", end - 1);
+        start = end + 1;
+
+        if (first == wstring::npos || first > last)
+            continue;
+
+        auto tag = header.substr(first, last - first + 1);
+        // Weak comparison.
+        if (tag.compare(0, 2, L"W/") == 0)
+            tag.erase(0, 2);
+
+        if (tag == L"*" || tag == etag)
+            return true;
+    }
+
+    return false;
+}
+
+// Get "v=<hex>" content version from query.
+static bool ParseVersion(const wchar_t *query, size_t length, uint64_t &version)
+{
+    for (size_t i = 0; i + 2 < length; i++)
+    {
+        if ((i > 0 && query[i - 1] != L'&') || query[i] != L'v' || query[i + 1] != L'=')
+            continue;
+
+        size_t end = i + 2;
+        version = 0;
+
+        while (end < length && iswxdigit(query[end]) && end - i - 2 < 16)
+        {
+            wchar_t c = query[end++];
+            version = (version << 4) | (c <= L'9' ? c - L'0' : (c | 0x20) - L'a' + 10);
+        }
+
+        return end > i + 2 && (end == length || query[end] == L'&');
+    }
+
+    return false;
+}
+
+// Parse single range "bytes=first-last" like Chromium does.
+// Returns 0 to ignore, 206 for valid range or 416 if not satisfiable.
+static int ParseRange(const wstring &header, int64 length, int64 &first, int64 &last)
+{
+    static const wchar_t unit[] = L"bytes=";
+    const size_t unit_length = COUNT_OF(unit) - 1;
+
+    if (header.compare(0, unit_length, unit) != 0
+        || header.find(L',') != wstring::npos)
+        return 0;
+
+    auto spec = header.substr(unit_length);
+    size_t dash = spec.find(L'-');
+    if (dash == wstring::npos)
+        return 0;
+
+    auto a = spec.substr(0, dash);
+    auto b = spec.substr(dash + 1);
+    if (a.empty() && b.empty())
+        return 0;
+    if (a.find_first_not_of(L"0123456789 ") != wstring::npos
+        || b.find_first_not_of(L"0123456789 ") != wstring::npos)
+        return 0;
+
+    if (a.empty())
+    {
+        // Suffix range, last N bytes.
+        int64 n = wcstoll(b.c_str(), nullptr, 10);
+        if (n <= 0 || length <= 0)
+            return 416;
+
+        first = std::max<int64>(0, length - n);
+        last = length - 1;
+        return 206;
+    }
+
+    first = wcstoll(a.c_str(), nullptr, 10);
+    last = length - 1;
+
+    if (!b.empty() && (last = wcstoll(b.c_str(), nullptr, 10)) < first)
+        return 0;
+    if (first >= length)
+        return 416;
+
+    last = std::min(last, length - 1);
+    return 206;
+}
+
+struct AssetFingerprint
+{
+    int64 size;
+    int64 mtime;
+    uint64_t hash;
+};
+
+static std::mutex fingerprints_mutex_;
+static std::unordered_map<wstring, AssetFingerprint> fingerprints_;
+
+// Check requested version against content hash, same as the loader computes.
+static bool MatchFingerprint(assets::Source &source, const wstring &path, int64 size, int64 mtime, uint64_t version)
+{
+    {
+        std::lock_guard<std::mutex> lock(fingerprints_mutex_);
+
+        auto it = fingerprints_.find(path);
+        if (it != fingerprints_.end() && it->second.size == size && it->second.mtime == mtime)
+            return it->second.hash == version;
+    }
+
+    std::shared_ptr<const void> owner;
+    const char *data;
+    int64 length;
+
+    if (!source.open(path, size, mtime, owner, data, length, nullptr))
+        return false;
+
+    uint64_t hash = utils::hashContent(data, static_cast<size_t>(length));
+
+    std::lock_guard<std::mutex> lock(fingerprints_mutex_);
+    fingerprints_[path] = AssetFingerprint{ size, mtime, hash };
+
+    return hash == version;
+}
+
+assets::Response::Response() : status(404)
+    , import(IMPORT_DEFAULT)
+    , path{}
+    , size(0)
+    , mtime(0)
+    , owner{}
+    , data(nullptr)
+    , length(0)
+    , mime(nullptr)
+    , etag{}
+    , last_modified{}
+    , range{}
+    , immutable(false)
+    , cache_hit(false)
+    , preload(false)
+{
+}
+
+static bool IsNotModified(const assets::Request &request, const assets::Response &response)
+{
+    auto if_none_match = request.header("If-None-Match");
+    if (!if_none_match.empty())
+        return MatchETag(if_none_match, response.etag);
+
+    auto if_modified_since = request.header("If-Modified-Since");
+    int64 since;
+
+    // HTTP date has seconds precision.
+    return !if_modified_since.empty()
+        && assets::parseHttpDate(if_modified_since, since)
+        && response.mtime / 10000000 <= since / 10000000;
+}
+
+// Resolve, classify and open request, then prepare response headers.
+void assets::serve(Source &source, const Request &request, Response &response)
+{
+    const wchar_t *query = request.query.c_str();
+    size_t query_length = request.query.length();
+    bool js_mime = false;
+
+    if (!source.locate(request.path, request.plugin, response.path, js_mime))
+        return;
+
+    // Detect relative plugin imports by referer //plugins.
+    auto import = request.plugin ? assets::classifyImport(request.referrer.c_str(), request.referrer.length(),
+        query, query_length, response.path.c_str(), response.path.length()) : IMPORT_DEFAULT;
+
+    response.import = import;
+    if (!source.stat(response.path, response.size, response.mtime))
+        return;
+
+    const auto &path = response.path;
+    int64 size = response.size, mtime = response.mtime;
+    uint64_t version;
+
+    // Fingerprinted URL never changes, let it stay in cache.
+    if (import == IMPORT_DEFAULT && ParseVersion(query, query_length, version))
+    {
+        response.immutable = MatchFingerprint(source, path, size, mtime, version);
+        // Plugin entry, warm up its imports meanwhile.
+        response.preload = request.plugin && js_mime;
+    }
+
+    // Strong validators by file identity, wrappers differ from raw file.
+    wchar_t etag[64];
+    swprintf(etag, COUNT_OF(etag), L"\"%llx-%llx-%d\"", static_cast<unsigned long long>(response.size),
+        static_cast<unsigned long long>(response.mtime), import);
+    response.etag.assign(etag);
+    response.last_modified = formatHttpDate(response.mtime);
+
+    if (IsNotModified(request, response))
+    {
+        response.status = 304;
+        return;
+    }
+
+    if (import == IMPORT_JSON || import == IMPORT_RAW)
+    {
+        js_mime = true;
+        if (!CreateInlineModule(source, path, size, mtime, import == IMPORT_JSON,
+            response.owner, response.data, response.length))
+            return;
+    }
+    else if (import != IMPORT_DEFAULT)
+    {
+        js_mime = true;
+        response.data = module_scripts[import].data;
+        response.length = module_scripts[import].size;
+    }
+    else if (!source.open(path, response.size, response.mtime,
+        response.owner, response.data, response.length, &response.cache_hit))
+    {
+        // Couldn't be mapped, caller streams it.
+        response.length = response.size;
+    }
+
+    response.status = 200;
+
+    // CEF skips to and reads the requested range itself,
+    // we just need to reply 206 with proper headers.
+    auto range = request.header("Range");
+    if (!range.empty())
+    {
+        int64 first, last, length = response.length;
+        int status = ParseRange(range, length, first, last);
+
+        if (status == 206)
+        {
+            response.status = 206;
+            response.range = L"bytes " + std::to_wstring(first) + L"-"
+                + std::to_wstring(last) + L"/" + std::to_wstring(length);
+        }
+        else if (status == 416)
+        {
+            response.status = 416;
+            response.range = L"bytes */" + std::to_wstring(length);
+        }
+    }
+
+    size_t pos;
+    if (js_mime)
+    {
+        // Already known JavaScript module.
+        response.mime = "text/javascript";
+    }
+    else if ((pos = path.find_last_of(L'.')) != wstring::npos)
+    {
+        // Get MIME type from file extension, the rest is up to caller.
+        response.mime = utils::getMimeType(path.c_str() + pos + 1, path.length() - pos - 1);
+    }
+}
+
+int assets::readBody(const Response &response, int64 &offset, void *out, int size)
+{
+    if (response.data == nullptr || size <= 0 || offset < 0 || offset >= response.length)
+        return 0;
+
+    int read = static_cast<int>(std::min<int64>(size, response.length - offset));
+    memcpy(out, response.data + offset, static_cast<size_t>(read));
+    offset += read;
+    return read;
+}
\ No newline at end of file
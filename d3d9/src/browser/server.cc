@@ -95,6 +95,24 @@ private:
             return;
         }
 
+        std::wregex metrics_re( L"^http://[\\d.]+:\\d+/metrics/?$" );
+
+        if (method == L"GET" && std::regex_search(url, metrics_re))
+        {
+            string data = metrics::dumpJson();
+
+            // Plugins fetch it from riot: origin.
+            auto headers = CefStringMultimap_Alloc();
+            CefStringMultimap_Append(headers, &"Access-Control-Allow-Origin"_s, &"*"_s);
+            CefStringMultimap_Append(headers, &"Cache-Control"_s, &"no-store"_s);
+
+            server->send_http_response(server, connection_id, 200, &"application/json"_s, data.length(), headers);
+            server->send_raw_data(server, connection_id, data.c_str(), data.length());
+            CefStringMultimap_Free(headers);
+
+            return;
+        }
+
         server->send_http404response(server, connection_id);
     }
 
@@ -0,0 +1,550 @@
+#ifndef _LEAGUE_LOADER_COMMON_H
+#define _LEAGUE_LOADER_COMMON_H
+
+// Platform-neutral part of internal.h, no Windows or CEF API in here.
+// Sources including only this header also build on Linux, see tests.
+
+#ifndef COUNT_OF
+#define COUNT_OF(arr) (sizeof(arr) / sizeof(*arr))
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// int64 same as CEF.
+#include "include/base/cef_basictypes.h"
+
+using std::string;
+using std::wstring;
+using std::vector;
+
+namespace utils
+{
+    wstring toWide(const string &str);
+    string toNarrow(const wstring &wstr);
+    wstring encodeBase64(const wstring &str);
+    void appendJsonString(string &out, const string &str);
+    uint64_t hashContent(const char *data, size_t size);
+
+    bool strEqual(const wstring &a, const wstring &b, bool sensitive = true);
+    bool strContain(const wstring &str, const wstring &sub, bool sensitive = true);
+    bool strStartWith(const wstring &str, const wstring &sub);
+    bool strEndWith(const wstring &str, const wstring &sub);
+
+    // Monotonic clock in microseconds.
+    int64 tickMicros();
+
+    // Paths are '\\' separated, also on Linux.
+    bool dirExist(const wstring &path);
+    bool fileExist(const wstring &path);
+    bool readFile(const wstring &path, string &out);
+    bool statFile(const wstring &path, int64 &size, int64 &mtime);
+    bool statDir(const wstring &path, int64 &mtime);
+    vector<wstring> readDir(const std::wstring &dir);
+    // First of candidates found in package folder, then index.js, see getPackageEntry.
+    wstring findPackageEntry(const wstring &folder, vector<wstring> candidates);
+
+    // Case-insensitive lookup by extension without dot, null if unknown.
+    const char *getMimeType(const wchar_t *ext, size_t length);
+
+    // Plugin pack (.llpk) entry, name is lower-case '/' separated path.
+    struct PackEntry
+    {
+        string name;
+        const char *data;
+        size_t size;
+    };
+
+    bool readPack(const char *pack, size_t size, vector<PackEntry> &out);
+    bool findPackEntry(const char *pack, size_t size, const string &name, const char *&data, size_t &length);
+    bool writePack(vector<PackEntry> entries, string &out);
+
+    // Read-only memory-mapped view of a whole file,
+    // section object on Windows, mmap elsewhere.
+    class FileMapping
+    {
+    public:
+        FileMapping();
+        ~FileMapping();
+
+        // With copy_on_write, view is writable but writes stay private to the process.
+        // On Windows the file is also opened deny-write, so no other write shows through.
+        bool open(const wstring &path, bool copy_on_write = false);
+        void close();
+
+        const char *data() const { return data_; }
+        size_t size() const { return size_; }
+
+    private:
+#ifdef _WIN32
+        void *file_;        // HANDLE
+        void *section_;
+#endif
+        const char *data_;
+        size_t size_;
+
+        FileMapping(const FileMapping &) = delete;
+        FileMapping &operator =(const FileMapping &) = delete;
+    };
+
+    // Shared values by key, LRU by bytes. Entries carry size and mtime of their
+    // file, so an edited file is a miss.
+    template <typename T>
+    class LruByteCache
+    {
+    public:
+        LruByteCache() : bytes_(0), hits_(0), misses_(0), evictions_(0)
+        {
+        }
+
+        // Null on miss, stale entry is dropped.
+        std::shared_ptr<const T> find(const wstring &key, int64 size, int64 mtime)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            auto it = map_.find(key);
+            if (it != map_.end())
+            {
+                auto &entry = *it->second;
+                if (entry.size == size && entry.mtime == mtime)
+                {
+                    // Move to front.
+                    order_.splice(order_.begin(), order_, it->second);
+                    ++hits_;
+                    return entry.value;
+                }
+
+                bytes_ -= entry.bytes;
+                order_.erase(it->second);
+                map_.erase(it);
+            }
+
+            ++misses_;
+            return nullptr;
+        }
+
+        // Keeps value of given bytes, then evicts least recently used over budget.
+        void insert(const wstring &key, int64 size, int64 mtime, int64 bytes,
+            std::shared_ptr<const T> value, int64 budget)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            // Someone else has just loaded it.
+            if (map_.find(key) != map_.end())
+                return;
+
+            order_.push_front(Entry{ key, size, mtime, bytes, std::move(value) });
+            map_.emplace(key, order_.begin());
+            bytes_ += bytes;
+
+            while (bytes_ > budget && !order_.empty())
+            {
+                auto &last = order_.back();
+                bytes_ -= last.bytes;
+                map_.erase(last.key);
+                order_.pop_back();
+                ++evictions_;
+            }
+        }
+
+        // Drops entries whose key matches.
+        void evict(const std::function<bool(const wstring &key)> &match)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            for (auto it = order_.begin(); it != order_.end();)
+            {
+                if (match(it->key))
+                {
+                    bytes_ -= it->bytes;
+                    map_.erase(it->key);
+                    it = order_.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+
+        void getStats(int64 &hits, int64 &misses, int64 &evictions, int64 &bytes, int64 &entries)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            hits = hits_;
+            misses = misses_;
+            evictions = evictions_;
+            bytes = bytes_;
+            entries = static_cast<int64>(map_.size());
+        }
+
+    private:
+        struct Entry
+        {
+            wstring key;
+            int64 size;     // of file
+            int64 mtime;
+            int64 bytes;    // of value
+            std::shared_ptr<const T> value;
+        };
+
+        std::mutex mutex_;
+        std::list<Entry> order_;
+        std::unordered_map<wstring, typename std::list<Entry>::iterator> map_;
+        int64 bytes_;
+
+        std::atomic<int64> hits_;
+        std::atomic<int64> misses_;
+        std::atomic<int64> evictions_;
+
+        LruByteCache(const LruByteCache &) = delete;
+        LruByteCache &operator =(const LruByteCache &) = delete;
+    };
+
+#ifdef LL_ALLOC_STATS
+    // Heap allocations made by calling thread, see utils/alloc.cc.
+    int64 allocCount();
+#endif
+}
+
+// Startup timeline, timestamps are utils::tickMicros() so processes line up.
+namespace trace
+{
+    // Reads config and flushes spans recorded so far, never call it from DllMain.
+    void start();
+    // Writes header and spans so far to file then keeps appending, or stops
+    // recording with null file. First call only, done by start().
+    void open(FILE *file, const string &process);
+    bool enabled();
+
+    void complete(const string &name, int64 start, int64 duration);
+    // Span across callbacks or threads, returns 0 if disabled.
+    uint64_t asyncBegin(const string &name);
+    void asyncEnd(const string &name, uint64_t id);
+
+    // Records from construction to end() or destruction.
+    class Span
+    {
+    public:
+        explicit Span(const char *name);
+        ~Span();
+
+        void end();
+
+    private:
+        const char *name_;
+        int64 start_;
+
+        Span(const Span &) = delete;
+        Span &operator =(const Span &) = delete;
+    };
+}
+
+#define TRACE_SPAN(name) trace::Span _trace_span(name)
+
+namespace assets
+{
+    // Plugin import kind by query flags and extension, also metrics bucket.
+    enum ImportType
+    {
+        IMPORT_DEFAULT = 0,
+        IMPORT_CSS,
+        IMPORT_JSON,
+        IMPORT_RAW,
+        IMPORT_URL
+    };
+
+    // Only imports referred by a plugin module are classified, others are IMPORT_DEFAULT.
+    ImportType classifyImport(const wchar_t *referrer, size_t referrer_length,
+        const wchar_t *query, size_t query_length, const wchar_t *path, size_t path_length);
+
+    // Assets/plugins request serving without CEF, browser process only. File access
+    // goes through Source, so traces can be replayed off a synthetic tree.
+    class Source
+    {
+    public:
+        virtual ~Source() {}
+
+        // Full path of request path, js is set for resolved module.
+        virtual bool locate(const wstring &request, bool plugin, wstring &path, bool &js) = 0;
+        virtual bool stat(const wstring &path, int64 &size, int64 &mtime) = 0;
+        // Read-only view of content, kept alive by owner.
+        virtual bool open(const wstring &path, int64 size, int64 mtime,
+            std::shared_ptr<const void> &owner, const char *&data, int64 &length, bool *cached) = 0;
+    };
+
+    struct Request
+    {
+        wstring path;       // URI decoded, without query
+        wstring query;
+        wstring referrer;
+        bool plugin;
+        // Request header by name, empty if not present.
+        std::function<wstring(const char *name)> header;
+    };
+
+    struct Response
+    {
+        int status;         // 404 if not found
+        int import;
+        wstring path;       // resolved file
+        int64 size;
+        int64 mtime;
+        // Memory view, or null to stream path.
+        std::shared_ptr<const void> owner;
+        const char *data;
+        int64 length;
+        const char *mime;   // null to look up by extension
+        wstring etag;
+        wstring last_modified;
+        wstring range;
+        bool immutable;
+        bool cache_hit;
+        bool preload;       // fingerprinted plugin entry
+
+        Response();
+    };
+
+    // Resolve, classify and open request, then prepare response headers.
+    // Disk source lives in browser/assets.cc, this part in browser/serve.cc.
+    void serve(Source &source, const Request &request, Response &response);
+    // Copies memory view from offset and moves it, as read callback of resource
+    // handler does. Never allocates, returns 0 at end or for streamed response.
+    int readBody(const Response &response, int64 &offset, void *out, int size);
+
+    // IMF-fixdate of FILETIME ticks (100 ns since 1601), seconds precision.
+    wstring formatHttpDate(int64 time);
+    bool parseHttpDate(const wstring &date, int64 &time);
+
+    // Recorded request, see browser/assetstrace.cc for the format.
+    struct TraceRecord
+    {
+        Request request;
+        wstring headers[3]; // If-None-Match, If-Modified-Since, Range
+        int status;
+        wstring path;       // relative to plugins/assets folder
+        int64 size;
+        int64 mtime;
+    };
+
+    // One trace line, file is response path relative to its root folder.
+    string formatTrace(const Request &request, const Response &response, const wstring &file);
+    // Records keep their address, header getters point to them.
+    void parseTrace(const string &content, vector<std::unique_ptr<TraceRecord>> &records);
+
+    // In-memory plugins/assets tree made of traced files, content is filler.
+    class SyntheticSource : public Source
+    {
+    public:
+        void add(bool plugin, const wstring &path, int64 size, int64 mtime);
+
+        bool locate(const wstring &request, bool plugin, wstring &path, bool &js) override;
+        bool stat(const wstring &path, int64 &size, int64 &mtime) override;
+        bool open(const wstring &path, int64 size, int64 mtime,
+            std::shared_ptr<const void> &owner, const char *&data, int64 &length, bool *cached) override;
+
+    private:
+        struct File
+        {
+            std::shared_ptr<const string> content;
+            int64 mtime;
+        };
+
+        struct Entry
+        {
+            bool dir;
+            wstring path;
+        };
+
+        std::unordered_map<wstring, File> files_;
+        std::unordered_map<wstring, Entry> index_;
+    };
+
+    struct ReplayResult
+    {
+        size_t requests;
+        int iterations;
+        double per_second;
+        double p50_us;
+        double p99_us;
+        double max_us;
+        int64 mismatches;   // status differs from trace
+        int64 allocs;       // -1 if not counted
+    };
+
+    // Serves records through source, iterations times over.
+    ReplayResult replay(Source &source, const vector<std::unique_ptr<TraceRecord>> &records, int iterations);
+    string formatReplay(const ReplayResult &result, const char *source);
+}
+
+// Plugins dir scan of renderer loader, one manifest entry per plugin or shared library.
+// package.json parsing and workers go through Host, so it also runs off a synthetic tree.
+namespace plugins
+{
+    // Load priority from "loader" field of plugin package.json.
+    enum Priority
+    {
+        PRIORITY_CRITICAL = 0,
+        PRIORITY_NORMAL,
+        PRIORITY_IDLE
+    };
+
+    // Plugin folder or pack in plugins dir, or library in _shared.
+    struct ManifestEntry
+    {
+        wstring name;       // folder or pack file name, _shared/<library>
+        int64 dir_mtime;    // folder only, recheck index.js when changed
+        bool valid;         // has entry module
+        int64 size;         // of index.js or pack
+        int64 mtime;
+        uint64_t hash;      // of index.js content
+        int64 meta_mtime;   // of package.json, folder only
+        int priority;
+        wstring route;      // lazy triggers
+        wstring selector;
+        wstring module;     // entry of shared library, relative to its folder
+    };
+
+    struct Manifest
+    {
+        int64 dir_mtime;
+        vector<ManifestEntry> entries;  // sorted by name
+    };
+
+    class Host
+    {
+    public:
+        virtual ~Host() {}
+
+        // Set priority, route and selector of entry from package.json content.
+        virtual void parseMeta(const char *data, size_t length, ManifestEntry &entry) = 0;
+        // Entry module of shared library folder, empty if not found.
+        virtual wstring getPackageEntry(const wstring &folder) = 0;
+        // Run task on a worker, false when it can't be queued.
+        virtual bool post(std::function<void()> task) = 0;
+    };
+
+    bool isPackName(const wstring &name);
+    bool isSharedName(const wstring &name);
+    // Plugin name of pack or library name of shared entry.
+    wstring getPluginName(const wstring &name);
+
+    bool parseManifest(const string &content, Manifest &manifest);
+    string formatManifest(const Manifest &manifest);
+    const ManifestEntry *findEntry(const Manifest &manifest, const wstring &name);
+    bool isEntryFresh(const wstring &dir, const ManifestEntry &entry);
+    // Check one plugin or library, hash and package.json are reused from known while unchanged.
+    void scanEntry(Host &host, const wstring &dir, const wstring &name, const ManifestEntry *known, ManifestEntry &out);
+
+    // Scan dir reusing known entries while unchanged, done gets the result and whether
+    // it differs from known. Runs on host workers, or all before return with wait.
+    void scan(Host &host, const wstring &dir, const Manifest &known,
+        std::function<void(Manifest &manifest, bool changed)> done, bool wait = false);
+}
+
+// Mapped plugin pack, shared by its entries.
+struct PluginPack
+{
+    utils::FileMapping file;
+    int64 mtime;
+};
+
+struct PluginsIndexEntry
+{
+    wstring path;   // original case, '\\' separated
+    bool dir;
+    // Packed file, points into pack view.
+    std::shared_ptr<PluginPack> pack;
+    const char *data;
+    size_t size;
+    // Folder entry module from its package.json, once looked up.
+    bool has_module;
+    wstring module;
+};
+
+// In-memory index of the plugins folder, keyed by lower-case relative path.
+// Filled by browser/resolver.cc from disk and its watcher.
+class PluginsIndex
+{
+public:
+    void Add(const wstring &path, bool dir);
+    void AddPacked(const wstring &path, const std::shared_ptr<PluginPack> &pack, const char *data, size_t size);
+    void Remove(const wstring &path);
+    void Swap(PluginsIndex &other);
+
+    bool Resolve(const wstring &request, wstring &resolved, bool &js);
+
+    // Resolve request path like the module loader does:
+    //   /name/       -> /name/index.js
+    //   /name/file   -> /name/file.js or /name/file/index.js
+    //   /name/x.js   -> as is, js set too
+    // lookup(key, dir, path) finds entry by lower-case '/' separated key.
+    template <typename Lookup>
+    static bool ResolveWith(const wstring &request, wstring &resolved, bool &js, Lookup &&lookup)
+    {
+        auto key = MakeKey(request);
+        wchar_t last = request.empty() ? 0 : request[request.length() - 1];
+        bool dir = false;
+
+        auto file = [&](const wstring &k) { return lookup(k, dir, resolved) && !dir; };
+        js = false;
+
+        // Trailing slash.
+        if (last == L'/' || last == L'\\')
+            return js = file(Join(key, L"index.js"));
+
+        size_t slash = key.find_last_of(L'/');
+        size_t dot = key.find_last_of(L'.');
+
+        // No extension.
+        if (dot == wstring::npos || (slash != wstring::npos && dot < slash))
+        {
+            wstring path{};
+
+            // peek .js
+            if (file(key + L".js"))
+                return js = true;
+            // peek folder
+            if (lookup(key, dir, path) && dir)
+                return js = file(Join(key, L"index.js"));
+        }
+
+        if (!file(key))
+            return false;
+
+        // Key is lower-case already.
+        js = utils::strEndWith(key, L".js") || utils::strEndWith(key, L".mjs");
+        return true;
+    }
+
+    bool IsDir(const wstring &path);
+    bool GetPacked(const wstring &path, std::shared_ptr<PluginPack> &pack, const char *&data, size_t &size);
+
+    // Cached entry module of folder, false if not looked up yet. Pass the
+    // epoch to SetModule, so a lookup raced by ClearModules is not kept.
+    bool GetModule(const wstring &dir, wstring &module, uint64_t &epoch);
+    void SetModule(const wstring &dir, const wstring &module, uint64_t epoch);
+    // Forget modules of path and its parent folders, any file below may change them.
+    void ClearModules(const wstring &path);
+
+    // Relative path with '.' and '..' folded, '\\' separated.
+    static wstring Normalize(const wstring &path);
+
+private:
+    std::mutex mutex_;
+    std::unordered_map<wstring, PluginsIndexEntry> map_;
+    uint64_t modules_epoch_ = 0;
+
+    static wstring MakeKey(const wstring &path);
+    static wstring Join(const wstring &key, const wchar_t *name);
+};
+
+#endif
\ No newline at end of file
@@ -17,6 +17,7 @@ static void Initialize()
     // Browser process.
     if (utils::strEqual(name, L"LeagueClientUx.exe", false))
     {
+        TRACE_SPAN("Initialize");
         if (LoadLibcefDll())
             HookBrowserProcess();
     }
@@ -24,6 +25,7 @@ static void Initialize()
     else if (utils::strEqual(name, L"LeagueClientUxRender.exe", false)
         && utils::strContain(GetCommandLineW(), L"--type=renderer", false))
     {
+        TRACE_SPAN("Initialize");
         if (LoadLibcefDll())
             HookRendererProcess();
     }
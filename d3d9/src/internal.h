@@ -21,6 +21,8 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <atomic>
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 #include <windows.h>
@@ -33,10 +35,9 @@
 #include "include/capi/cef_v8_capi.h"
 #include "include/capi/cef_request_capi.h"
 #include "include/capi/cef_server_capi.h"
+#include "include/capi/cef_task_capi.h"
 
-using std::string;
-using std::wstring;
-using std::vector;
+#include "common.h"
 
 template <typename T>
 class CefRefCount : public T
@@ -70,6 +71,22 @@ private:
     { return reinterpret_cast<CefRefCount *>(_)->ref_ != 0; }
 };
 
+// Run function as CEF task.
+class CefFunctionTask : public CefRefCount<cef_task_t>
+{
+public:
+    CefFunctionTask(std::function<void()> fn) : CefRefCount(this), fn_(std::move(fn))
+    {
+        cef_task_t::execute = _execute;
+    }
+
+private:
+    std::function<void()> fn_;
+
+    static void CALLBACK _execute(cef_task_t *_)
+    { static_cast<CefFunctionTask *>(_)->fn_(); }
+};
+
 struct CefStrBase : cef_string_t
 {
     CefStrBase() { dtor = nullptr; }
@@ -121,6 +138,7 @@ extern decltype(&cef_get_mime_type) CefGetMimeType;
 extern decltype(&cef_request_create) CefRequest_Create;
 extern decltype(&cef_string_multimap_alloc) CefStringMultimap_Alloc;
 extern decltype(&cef_string_multimap_free) CefStringMultimap_Free;
+extern decltype(&cef_string_multimap_append) CefStringMultimap_Append;
 extern decltype(&cef_register_extension) CefRegisterExtension;
 extern decltype(&cef_dictionary_value_create) CefDictionaryValue_Create;
 extern decltype(&cef_stream_reader_create_for_file) CefStreamReader_CreateForFile;
@@ -128,7 +146,9 @@ extern decltype(&cef_stream_reader_create_for_data) CefStreamReader_CreateForDat
 extern decltype(&cef_process_message_create) CefProcessMessage_Create;
 extern decltype(&cef_v8context_get_current_context) CefV8Context_GetCurrentContext;
 extern decltype(&cef_server_create) CefServer_Create;
+extern decltype(&cef_post_task) CefPostTask;
 extern decltype(&cef_uridecode) CefURIDecode;
+extern decltype(&cef_parse_json) CefParseJSON;
 
 // Strings helpers.
 extern decltype(&cef_string_set) CefString_Set;
@@ -146,6 +166,7 @@ extern decltype(&cef_v8value_create_string) CefV8Value_CreateString;
 extern decltype(&cef_v8value_create_function) CefV8Value_CreateFunction;
 extern decltype(&cef_v8value_create_array) CefV8Value_CreateArray;
 extern decltype(&cef_v8value_create_bool) CefV8Value_CreateBool;
+extern decltype(&cef_v8value_create_array_buffer) CefV8Value_CreateArrayBuffer;
 
 // Hooking entries.
 extern decltype(&cef_initialize) CefInitialize;
@@ -167,19 +188,30 @@ namespace config
 
 namespace utils
 {
-    wstring toWide(const string &str);
-    string toNarrow(const wstring &wstr);
-    wstring encodeBase64(const wstring &str);
+    // Entry module of package folder, relative '/' separated, empty if not found.
+    wstring getPackageEntry(const wstring &folder);
+
+    // Fixed size thread pool with bounded queue, workers live for the whole process.
+    class WorkerPool
+    {
+    public:
+        WorkerPool(size_t threads, size_t capacity);
 
-    bool strEqual(const wstring &a, const wstring &b, bool sensitive = true);
-    bool strContain(const wstring &str, const wstring &sub, bool sensitive = true);
-    bool strStartWith(const wstring &str, const wstring &sub);
-    bool strEndWith(const wstring &str, const wstring &sub);
+        // Returns false when the queue is full.
+        bool post(std::function<void()> task);
+        // Queued and running tasks.
+        size_t pending() const;
 
-    bool dirExist(const wstring &path);
-    bool fileExist(const wstring &path);
-    bool readFile(const wstring &path, string &out);
-    vector<wstring> readDir(const std::wstring &dir);
+    private:
+        struct State;
+        State *state_;
+        size_t capacity_;
+
+        static DWORD WINAPI worker(LPVOID param);
+
+        WorkerPool(const WorkerPool &) = delete;
+        WorkerPool &operator =(const WorkerPool &) = delete;
+    };
 
     void hookFunc(void **orig, void *hooked);
     template<typename T> void hookFunc(T *orig, T hooked) {
@@ -191,4 +223,32 @@ namespace utils
     void openFilesExplorer(const wstring &path);
 }
 
+// Asset serving metrics, browser process only.
+namespace metrics
+{
+    enum Route
+    {
+        ROUTE_ASSETS = 0,
+        ROUTE_PLUGINS,
+        ROUTE_RIOTCLIENT,
+        ROUTE_COUNT
+    };
+
+    // type is ImportType of assets handler, 0 for others.
+    void recordOpen(Route route, int type, int status, int64 micros, bool cache_hit);
+    void recordFirstByte(Route route, int type, int64 micros);
+    void recordBytes(Route route, int type, int64 bytes);
+    // Plugin entry import from fetch to evaluated, reported by renderer.
+    void recordPluginLoad(const wstring &name, bool ok, int64 micros, const wstring &error);
+
+    string dumpJson();
+}
+
+// Assets/plugins serving is in common.h, this is its source for the client.
+namespace assets
+{
+    // Plugins index, packs, shared cache and disk.
+    Source &diskSource();
+}
+
 #endif
\ No newline at end of file
@@ -7,6 +7,7 @@ decltype(&cef_get_mime_type) CefGetMimeType;
 decltype(&cef_request_create) CefRequest_Create;
 decltype(&cef_string_multimap_alloc) CefStringMultimap_Alloc;
 decltype(&cef_string_multimap_free) CefStringMultimap_Free;
+decltype(&cef_string_multimap_append) CefStringMultimap_Append;
 decltype(&cef_register_extension) CefRegisterExtension;
 decltype(&cef_dictionary_value_create) CefDictionaryValue_Create;
 decltype(&cef_stream_reader_create_for_file) CefStreamReader_CreateForFile;
@@ -14,7 +15,9 @@ decltype(&cef_stream_reader_create_for_data) CefStreamReader_CreateForData;
 decltype(&cef_process_message_create) CefProcessMessage_Create;
 decltype(&cef_v8context_get_current_context) CefV8Context_GetCurrentContext;
 decltype(&cef_server_create) CefServer_Create;
+decltype(&cef_post_task) CefPostTask;
 decltype(&cef_uridecode) CefURIDecode;
+decltype(&cef_parse_json) CefParseJSON;
 
 decltype(&cef_string_set) CefString_Set;
 decltype(&cef_string_clear) CefString_Clear;
@@ -30,6 +33,7 @@ decltype(&cef_v8value_create_string) CefV8Value_CreateString;
 decltype(&cef_v8value_create_function) CefV8Value_CreateFunction;
 decltype(&cef_v8value_create_array) CefV8Value_CreateArray;
 decltype(&cef_v8value_create_bool) CefV8Value_CreateBool;
+decltype(&cef_v8value_create_array_buffer) CefV8Value_CreateArrayBuffer;
 
 decltype(&cef_initialize) CefInitialize;
 decltype(&cef_execute_process) CefExecuteProcess;
@@ -80,22 +84,27 @@ static NOINLINE cef_color_t __fastcall Hooked_GetBackgroundColor(void *, void *,
 
 bool LoadLibcefDll()
 {
+    TRACE_SPAN("LoadLibcefDll");
     LPCWSTR filename = L"libcef.dll";
 
+    trace::Span version_span("CheckCefVersion");
     if (GetFileMajorVersion(filename) != CEF_VERSION_MAJOR)
     {
         CreateThread(NULL, 0, (LPTHREAD_START_ROUTINE)&WarnInvalidVersion, NULL, 0, NULL);
         return false;
     }
+    version_span.end();
 
     // libcef.dll is already loaded (our module is its dependency).
     if (HMODULE libcef = GetModuleHandle(filename))
     {
         // Get CEF functions.
+        trace::Span procs_span("GetCefProcAddresses");
         (LPVOID &)CefGetMimeType = GetProcAddress(libcef, "cef_get_mime_type");
         (LPVOID &)CefRequest_Create = GetProcAddress(libcef, "cef_request_create");
         (LPVOID &)CefStringMultimap_Alloc = GetProcAddress(libcef, "cef_string_multimap_alloc");
         (LPVOID &)CefStringMultimap_Free = GetProcAddress(libcef, "cef_string_multimap_free");
+        (LPVOID &)CefStringMultimap_Append = GetProcAddress(libcef, "cef_string_multimap_append");
         (LPVOID &)CefRegisterExtension = GetProcAddress(libcef, "cef_register_extension");
         (LPVOID &)CefDictionaryValue_Create = GetProcAddress(libcef, "cef_dictionary_value_create");
         (LPVOID &)CefStreamReader_CreateForFile = GetProcAddress(libcef, "cef_stream_reader_create_for_file");
@@ -103,7 +112,9 @@ bool LoadLibcefDll()
         (LPVOID &)CefProcessMessage_Create = GetProcAddress(libcef, "cef_process_message_create");
         (LPVOID &)CefV8Context_GetCurrentContext = GetProcAddress(libcef, "cef_v8context_get_current_context");
         (LPVOID &)CefServer_Create = GetProcAddress(libcef, "cef_server_create");
+        (LPVOID &)CefPostTask = GetProcAddress(libcef, "cef_post_task");
         (LPVOID &)CefURIDecode = GetProcAddress(libcef, "cef_uridecode");
+        (LPVOID &)CefParseJSON = GetProcAddress(libcef, "cef_parse_json");
 
         (LPVOID &)CefString_Set = GetProcAddress(libcef, "cef_string_utf16_set");
         (LPVOID &)CefString_Clear = GetProcAddress(libcef, "cef_string_utf16_clear");
@@ -119,13 +130,16 @@ bool LoadLibcefDll()
         (LPVOID &)CefV8Value_CreateFunction = GetProcAddress(libcef, "cef_v8value_create_function");
         (LPVOID &)CefV8Value_CreateArray = GetProcAddress(libcef, "cef_v8value_create_array");
         (LPVOID &)CefV8Value_CreateBool = GetProcAddress(libcef, "cef_v8value_create_bool");
+        (LPVOID &)CefV8Value_CreateArrayBuffer = GetProcAddress(libcef, "cef_v8value_create_array_buffer");
 
         (LPVOID &)CefInitialize = GetProcAddress(libcef, "cef_initialize");
         (LPVOID &)CefExecuteProcess = GetProcAddress(libcef, "cef_execute_process");
         (LPVOID &)CefBrowserHost_CreateBrowser = GetProcAddress(libcef, "cef_browser_host_create_browser");
+        procs_span.end();
 
         // Find CefContext::GetBackGroundColor().
         {
+            TRACE_SPAN("HookGetBackgroundColor");
             MODULEINFO info{ NULL };
             K32GetModuleInformation(GetCurrentProcess(), libcef, &info, sizeof(info));
 
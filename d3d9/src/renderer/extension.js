@@ -113,6 +113,52 @@ var requireFile = function (path) {
     return RequireFile(path);
 };
 
+var requireBinary = function (path) {
+    native function RequireBinary();
+    return RequireBinary(String(path));
+};
+
+var requireFileAsync = function (path) {
+    native function RequireFileAsync();
+    return new Promise((resolve, reject) => {
+        RequireFileAsync(String(path), resolve, err => reject(new Error(err)));
+    });
+};
+
+var Metrics = new function () {
+    native function GetMetricsURL();
+    native function GetRequireCacheStats();
+
+    return {
+        [Symbol.toStringTag]: 'Metrics',
+        get url() {
+            return GetMetricsURL();
+        },
+        get requireFile() {
+            var stats = JSON.parse(GetRequireCacheStats());
+            var total = stats.hits + stats.misses;
+            stats.hit_rate = total > 0 ? stats.hits / total : 0;
+            return stats;
+        },
+        async get() {
+            var res = await fetch(GetMetricsURL(), { cache: 'no-store' });
+            return await res.json();
+        }
+    };
+};
+
+// Plugin load results to metrics, used by loader only.
+var __llreport = function (name, ok, micros, error) {
+    native function ReportPluginLoad();
+    ReportPluginLoad(name, ok, micros, error);
+};
+
+// Startup trace of plugin modules, used by loader only.
+var __lltrace = function (phase, name, id) {
+    native function TracePlugin();
+    return TracePlugin(phase, name, id);
+};
+
 var AuthCallback = new function () {
     native function CreateAuthCallbackURL();
     native function AddAuthCallback();
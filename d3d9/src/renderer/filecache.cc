@@ -0,0 +1,89 @@
+#include "../internal.h"
+#include <cwctype>
+
+// RENDERER PROCESS ONLY.
+
+// Default budget in MB, can be changed by RequireCacheSize in config.
+static const int64 DEFAULT_CACHE_SIZE = 16;
+
+// requireFile() content already converted to UTF-16, LRU by bytes.
+class RequireCache
+{
+public:
+    RequireCache() : budget_(-1)
+    {
+    }
+
+    std::shared_ptr<const CefStr> Load(const wstring &path)
+    {
+        int64 size, mtime;
+        if (!utils::statFile(path, size, mtime))
+            return nullptr;
+
+        auto key = MakeKey(path);
+        if (auto text = cache_.find(key, size, mtime))
+            return text;
+
+        // Read and convert outside the lock.
+        string content{};
+        if (!utils::readFile(path, content))
+            return nullptr;
+
+        auto text = std::make_shared<const CefStr>(content);
+        int64 bytes = static_cast<int64>(text->length * sizeof(*text->str));
+
+        // Changed while reading, or too big to keep.
+        if (static_cast<int64>(content.length()) != size || bytes > GetBudget() / 4)
+            return text;
+
+        cache_.insert(key, size, mtime, bytes, text, GetBudget());
+        return text;
+    }
+
+    void GetStats(int64 &hits, int64 &misses, int64 &evictions, int64 &bytes, int64 &entries)
+    {
+        cache_.getStats(hits, misses, evictions, bytes, entries);
+    }
+
+private:
+    utils::LruByteCache<CefStr> cache_;
+    std::atomic<int64> budget_;
+
+    int64 GetBudget()
+    {
+        if (budget_ < 0)
+        {
+            auto value = config::getConfigValue(L"RequireCacheSize");
+            int64 mb = value.empty() ? DEFAULT_CACHE_SIZE : wcstol(value.c_str(), nullptr, 10);
+            budget_ = mb > 0 ? mb * 1024 * 1024 : 0;
+        }
+
+        return budget_;
+    }
+
+    // Same file by any spelling of its path.
+    static wstring MakeKey(const wstring &path)
+    {
+        WCHAR full[2048];
+        DWORD length = GetFullPathNameW(path.c_str(), COUNT_OF(full), full, NULL);
+
+        wstring key = length > 0 && length < COUNT_OF(full) ? wstring(full, length) : path;
+        for (auto &c : key)
+            c = c == L'/' ? L'\\' : towlower(c);
+
+        return key;
+    }
+};
+
+static RequireCache cache_;
+
+// Get requireFile() content as UTF-16, null if not found.
+std::shared_ptr<const CefStr> LoadRequireFile(const wstring &path)
+{
+    return cache_.Load(path);
+}
+
+void GetRequireCacheStats(int64 &hits, int64 &misses, int64 &evictions, int64 &bytes, int64 &entries)
+{
+    cache_.GetStats(hits, misses, evictions, bytes, entries);
+}
\ No newline at end of file
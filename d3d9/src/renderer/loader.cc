@@ -1,76 +1,538 @@
 #include "../internal.h"
-#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <unordered_map>
 
 // RENDERER PROCESS ONLY.
 
-void LoadPlugins(cef_frame_t *frame, cef_v8context_t *context)
+// Discovered plugins are kept in a manifest next to the loader. On launch
+// plugins from the manifest are scheduled right away, the folder is scanned
+// on workers meanwhile and new plugins are scheduled once it's done.
+// Without a manifest, the first scan runs inline before anything is imported.
+// Libraries in plugins/_shared are kept there too, for the import map.
+
+static const size_t SCAN_THREADS = 4;
+static const size_t MAX_PENDING_SCANS = 16;
+// requireFileAsync() reads, few threads so disk isn't thrashed.
+static const size_t READ_THREADS = 2;
+static const size_t MAX_PENDING_READS = 64;
+// requireBinary() copies smaller files, bigger ones are mapped and locked.
+static const int64 BINARY_COPY_LIMIT = 1024 * 1024;
+
+static const wchar_t *PRIORITY_NAMES[] = { L"critical", L"normal", L"idle" };
+
+// Bootstraps plugins of one manifest pass, shared is set on first pass.
+// Installs import map of '@plugins/<name>' and shared libraries before any module loads,
+// then imports by priority:
+//   critical   right away
+//   normal     once document is parsed
+//   idle       when the client is idle after load
+// plugins with route or selector are imported once it matches.
+// Each import is timed from fetch to evaluated and reported to native.
+static const wchar_t SCRIPT_BOOTSTRAP[] = LR"((plugins, shared, report, trace) => {
+    const load = p => {
+        if (p.loaded) return;
+        p.loaded = true;
+        const id = trace && trace('b', p.name);
+        const start = performance.now();
+        const done = (ok, error) => {
+            report(p.name, ok, Math.round((performance.now() - start) * 1000), error);
+            if (trace) trace('e', p.name, id);
+        };
+        import(p.url).then(() => done(true, ''), e => {
+            console.error(`Failed to load plugin "${p.name}":`, e);
+            done(false, String(e && e.stack || e));
+        });
+    };
+    const ready = fn => document.readyState === 'loading'
+        ? document.addEventListener('DOMContentLoaded', fn, { once: true }) : fn();
+    const loaded = fn => document.readyState === 'complete'
+        ? fn() : window.addEventListener('load', fn, { once: true });
+
+    const schedule = () => {
+        const lazy = [];
+
+        for (const p of plugins) {
+            if (p.route || p.selector) lazy.push(p);
+            else if (p.priority === 'critical') load(p);
+            else if (p.priority === 'idle') loaded(() => requestIdleCallback(() => load(p), { timeout: 10000 }));
+            else ready(() => load(p));
+        }
+
+        if (lazy.length === 0) return;
+
+        // Check triggers at most once per tick of changes.
+        let pending = false;
+        const check = () => {
+            pending = false;
+            for (const p of lazy) {
+                if (!p.loaded && ((p.route && location.href.includes(p.route))
+                    || (p.selector && document.querySelector(p.selector)))) load(p);
+            }
+            if (lazy.every(p => p.loaded)) {
+                observer.disconnect();
+                window.removeEventListener('hashchange', changed);
+                window.removeEventListener('popstate', changed);
+            }
+        };
+        const changed = () => { if (!pending) { pending = true; setTimeout(check, 50); } };
+        const observer = new MutationObserver(changed);
+
+        window.addEventListener('hashchange', changed);
+        window.addEventListener('popstate', changed);
+        ready(() => { observer.observe(document.documentElement, { childList: true, subtree: true }); changed(); });
+    };
+
+    if (!shared) return schedule();
+
+    // Import map is ignored once a module starts loading, so it goes first.
+    const install = () => {
+        const imports = {};
+        for (const [lib, entry] of Object.entries(shared)) {
+            imports[lib] = `https://plugins/_shared/${lib}/${entry}`;
+            imports[lib + '/'] = `https://plugins/_shared/${lib}/`;
+        }
+        for (const p of plugins) imports['@plugins/' + p.name] = p.url;
+
+        const script = document.createElement('script');
+        script.type = 'importmap';
+        script.textContent = JSON.stringify({ imports });
+        (document.head || document.documentElement).prepend(script);
+        schedule();
+    };
+
+    if (document.documentElement) install();
+    else new MutationObserver((_, o) => { if (document.documentElement) { o.disconnect(); install(); } })
+        .observe(document, { childList: true });
+})";
+
+static std::mutex manifest_mutex_;
+static std::unique_ptr<plugins::Manifest> manifest_;
+// Bumped by each load, late imports for old page are dropped.
+static std::atomic<int> generation_{ 0 };
+
+static utils::WorkerPool &GetScanPool()
 {
-    auto pluginsDir = config::getPluginsDir();
+    static auto pool = new utils::WorkerPool(SCAN_THREADS, MAX_PENDING_SCANS);
+    return *pool;
+}
+
+static wstring GetManifestPath()
+{
+    return config::getLoaderDir() + L"\\plugins.manifest";
+}
 
-    if (!utils::dirExist(pluginsDir))
+static bool ReadManifest(plugins::Manifest &manifest)
+{
+    string content{};
+    return utils::readFile(GetManifestPath(), content) && plugins::parseManifest(content, manifest);
+}
+
+static void WriteManifest(const plugins::Manifest &manifest)
+{
+    string content = plugins::formatManifest(manifest);
+
+    // Write to temp file then replace, other renderers may read it.
+    // Temp name is per process, renderers finishing a scan together may write it too.
+    auto path = GetManifestPath();
+    auto temp = path + L".tmp." + std::to_wstring(GetCurrentProcessId());
+
+    std::ofstream stream(temp, std::ios::binary | std::ios::trunc);
+    bool ok = stream.write(content.data(), content.length()).good();
+    stream.close();
+
+    if (!ok || !MoveFileExW(temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING))
+        DeleteFileW(temp.c_str());
+}
+
+static wstring GetMetaString(cef_dictionary_value_t *dict, const char *key)
+{
+    CefScopedStr value{ dict->get_string(dict, &CefStr(key, strlen(key))) };
+    auto str = value.cstr();
+
+    // Manifest is tab separated.
+    for (auto &c : str)
+        if (c == L'\t' || c == L'\r' || c == L'\n') c = L' ';
+
+    return str;
+}
+
+// Read "loader" field of package.json:
+//   { "loader": { "priority": "critical|normal|idle", "route": "...", "selector": "..." } }
+static void ParsePluginMeta(const char *data, size_t length, plugins::ManifestEntry &entry)
+{
+    entry.priority = plugins::PRIORITY_NORMAL;
+    entry.route.clear();
+    entry.selector.clear();
+
+    auto value = CefParseJSON(&CefStr(data, length), JSON_PARSER_ALLOW_TRAILING_COMMAS);
+    if (value == nullptr)
         return;
 
-    using namespace std::chrono;
-    auto current_time = system_clock::now();
-    auto current_ms = duration_cast<milliseconds>(current_time.time_since_epoch()).count();
+    auto root = value->get_type(value) == VTYPE_DICTIONARY ? value->get_dictionary(value) : nullptr;
+    auto loader = root != nullptr && root->get_type(root, &"loader"_s) == VTYPE_DICTIONARY
+        ? root->get_dictionary(root, &"loader"_s) : nullptr;
+
+    if (loader != nullptr)
+    {
+        auto priority = GetMetaString(loader, "priority");
+        for (size_t i = 0; i < COUNT_OF(PRIORITY_NAMES); i++)
+            if (priority == PRIORITY_NAMES[i]) entry.priority = static_cast<int>(i);
+
+        entry.route = GetMetaString(loader, "route");
+        entry.selector = GetMetaString(loader, "selector");
+        loader->base.release(&loader->base);
+    }
+
+    if (root != nullptr)
+        root->base.release(&root->base);
+    value->base.release(&value->base);
+}
+
+class ScanHost : public plugins::Host
+{
+public:
+    void parseMeta(const char *data, size_t length, plugins::ManifestEntry &entry) override
+    {
+        ParsePluginMeta(data, length, entry);
+    }
+
+    wstring getPackageEntry(const wstring &folder) override
+    {
+        return utils::getPackageEntry(folder);
+    }
+
+    bool post(std::function<void()> task) override
+    {
+        return GetScanPool().post(std::move(task));
+    }
+};
+
+static ScanHost &GetScanHost()
+{
+    static ScanHost host{};
+    return host;
+}
+
+// Scan plugins dir and keep its manifest, rewritten only when changed.
+// With wait, all of it runs on the calling thread and done is called before return.
+static void ScanPlugins(const plugins::Manifest &known, std::function<void(const plugins::Manifest &)> done, bool wait = false)
+{
+    int64 start = utils::tickMicros();
+
+    plugins::scan(GetScanHost(), config::getPluginsDir(), known, [done, start](plugins::Manifest &scanned, bool changed)
+    {
+        auto manifest = std::unique_ptr<plugins::Manifest>(new plugins::Manifest(std::move(scanned)));
 
+        if (changed)
+            WriteManifest(*manifest);
+
+        done(*manifest);
+        trace::complete("ScanPlugins", start, utils::tickMicros() - start);
+
+        std::lock_guard<std::mutex> lock(manifest_mutex_);
+        manifest_ = std::move(manifest);
+    }, wait);
+}
+
+// Append as JS string literal body.
+static void AppendJsString(wstring &out, const wstring &str)
+{
+    for (auto c : str)
+    {
+        if (c == L'"' || c == L'\\')
+        {
+            out.push_back(L'\\');
+            out.push_back(c);
+        }
+        else if (c < 0x20)
+        {
+            wchar_t escape[8];
+            swprintf(escape, COUNT_OF(escape), L"\\u%04x", c);
+            out.append(escape);
+        }
+        else
+        {
+            out.push_back(c);
+        }
+    }
+}
+
+// Run bootstrap with entries not in skip manifest.
+static void SchedulePlugins(cef_frame_t *frame, const plugins::Manifest &manifest, const plugins::Manifest *skip)
+{
     int count = 0;
-    std::wstring script = L"(() => { ";
+    std::wstring script = L"(";
+    script.append(SCRIPT_BOOTSTRAP).append(L")([");
 
-    // Scan plugins dir.
-    for (const auto &name : utils::readDir(pluginsDir + L"\\*"))
+    for (const auto &entry : manifest.entries)
     {
-        // Skip name starts with underscore or dot.
-        if (name[0] == '_' || name[0] == '.')
+        if (!entry.valid || plugins::isSharedName(entry.name))
             continue;
 
-        // Skip folder has no index.
-        if (utils::fileExist(pluginsDir + L"\\" + name + L"\\index.js"))
+        if (skip != nullptr)
+        {
+            auto known = plugins::findEntry(*skip, entry.name);
+            if (known != nullptr && known->valid)
+                continue;
+        }
+
+        // Content fingerprint as version, unchanged plugins hit the cache.
+        wchar_t version[17];
+        swprintf(version, COUNT_OF(version), L"%016llx", entry.hash);
+
+        auto name = plugins::getPluginName(entry.name);
+        script.append(L"{ name: \"");
+        AppendJsString(script, name);
+        script.append(L"\", url: \"https://plugins/");
+        AppendJsString(script, name);
+        script.append(L"/index.js?v=").append(version);
+        script.append(L"\", priority: \"").append(PRIORITY_NAMES[entry.priority]);
+        script.append(L"\", route: \"");
+        AppendJsString(script, entry.route);
+        script.append(L"\", selector: \"");
+        AppendJsString(script, entry.selector);
+        script.append(L"\" }, ");
+
+        count++;
+    }
+
+    // First pass of this page owns the import map.
+    if (skip == nullptr)
+    {
+        script.append(L"], {");
+
+        for (const auto &entry : manifest.entries)
         {
-            script.append(L"import(\"https://plugins/");
-            script.append(name + L"/index.js?t=");
-            script.append(std::to_wstring(current_ms));
-            script.append(L"\"); ");
+            if (!entry.valid || !plugins::isSharedName(entry.name))
+                continue;
 
-            count++;
+            script.append(L" \"");
+            AppendJsString(script, plugins::getPluginName(entry.name));
+            script.append(L"\": \"");
+            AppendJsString(script, entry.module);
+            script.append(L"\",");
         }
+
+        script.append(L" }");
+    }
+    else
+    {
+        script.append(L"], null");
     }
 
-    script.append(L"})();");
+    script.append(L", __llreport");
+    // Module evaluation spans, see TracePlugin native.
+    script.append(trace::enabled() ? L", __lltrace);" : L");");
 
-    // Execute script.
-    if (count > 0)
+    // Execute script, first pass always runs to install the import map.
+    if (count > 0 || skip == nullptr)
     {
         cef_string_t _script = CefStr(script).forawrd();
         frame->execute_java_script(frame, &_script, &""_s, 1);
     }
 }
 
-bool HandlePlugins(const wstring &fn, const vector<cef_v8value_t *> &args, cef_v8value_t * &retval)
+void LoadPlugins(cef_frame_t *frame, cef_v8context_t *context)
 {
-    if (fn == L"RequireFile")
+    TRACE_SPAN("LoadPlugins");
+
+    if (!utils::dirExist(config::getPluginsDir()))
+        return;
+
+    plugins::Manifest known{};
+    bool trusted = false;
+
     {
-        if (args.size() > 0 && args[0]->is_string(args[0]))
+        std::lock_guard<std::mutex> lock(manifest_mutex_);
+        if (manifest_ != nullptr)
         {
-            string content{};
-            CefScopedStr path_tmp{ args[0]->get_string_value(args[0]) };
-            CefScopedStr path{ CefURIDecode(&path_tmp, true,
-                static_cast<cef_uri_unescape_rule_t>(UU_SPACES | UU_URL_SPECIAL_CHARS_EXCEPT_PATH_SEPARATORS)) };
-            wstring _path{ path.str, path.length };
+            known = *manifest_;
+            trusted = true;
+        }
+    }
 
-            size_t pos = _path.find(L"//");
-            if (pos != string::npos)
-                _path = _path.substr(pos + 2);
+    int generation = ++generation_;
+
+    // No manifest yet, first launch. Import map is ignored once a module starts
+    // loading, so it can't wait for a background scan, scan right here once.
+    if (!trusted && !ReadManifest(known))
+    {
+        ScanPlugins(known, [frame](const plugins::Manifest &manifest)
+        {
+            SchedulePlugins(frame, manifest, nullptr);
+        }, true);
+        return;
+    }
+
+    // Trust last known plugins whose entry is unchanged, one stat each. Changed ones
+    // would load stale code by their old immutable URL, rehash them right here: the
+    // first pass installs the import map, so it must list every plugin.
+    // Scan still starts from the manifest as read, so changes get written.
+    auto dir = config::getPluginsDir();
+    plugins::Manifest scheduled = known;
+
+    for (auto &entry : scheduled.entries)
+    {
+        if (entry.valid && !plugins::isSharedName(entry.name) && !plugins::isEntryFresh(dir, entry))
+        {
+            auto last = entry;
+            plugins::scanEntry(GetScanHost(), dir, last.name, &last, entry);
+        }
+    }
 
-            if (_path.length() > 1 && _path[0] == L'/')
-                _path = _path.substr(1);
+    SchedulePlugins(frame, scheduled, nullptr);
+    frame->base.add_ref(&frame->base);
 
-            _path = config::getLoaderDir()
-                .append(L"/").append(_path);
+    ScanPlugins(known, [frame, generation, scheduled](const plugins::Manifest &manifest)
+    {
+        auto scanned = std::make_shared<plugins::Manifest>(manifest);
+
+        CefPostTask(TID_RENDERER, new CefFunctionTask([frame, generation, scheduled, scanned]
+        {
+            if (generation == generation_ && frame->is_valid(frame))
+                SchedulePlugins(frame, *scanned, &scheduled);
+
+            frame->base.release(&frame->base);
+        }));
+    });
+}
+
+std::shared_ptr<const CefStr> LoadRequireFile(const wstring &path);
+void GetRequireCacheStats(int64 &hits, int64 &misses, int64 &evictions, int64 &bytes, int64 &entries);
+
+// File path of requireFile() argument, relative to loader folder.
+static wstring GetRequirePath(cef_v8value_t *arg)
+{
+    CefScopedStr path_tmp{ arg->get_string_value(arg) };
+    CefScopedStr path{ CefURIDecode(&path_tmp, true,
+        static_cast<cef_uri_unescape_rule_t>(UU_SPACES | UU_URL_SPECIAL_CHARS_EXCEPT_PATH_SEPARATORS)) };
+    wstring _path{ path.str, path.length };
+
+    size_t pos = _path.find(L"//");
+    if (pos != string::npos)
+        _path = _path.substr(pos + 2);
+
+    if (_path.length() > 1 && _path[0] == L'/')
+        _path = _path.substr(1);
+
+    return config::getLoaderDir()
+        .append(L"/").append(_path);
+}
 
-            if (utils::readFile(_path, content))
+// Owns memory behind requireBinary() ArrayBuffer, released once it's collected.
+class BinaryRelease : public CefRefCount<cef_v8array_buffer_release_callback_t>
+{
+public:
+    BinaryRelease() : CefRefCount(this)
+    {
+        cef_v8array_buffer_release_callback_t::release_buffer = _release_buffer;
+    }
+
+    utils::FileMapping mapping;
+    string content;     // small file, or fallback if file can't be mapped
+
+private:
+    static void CALLBACK _release_buffer(cef_v8array_buffer_release_callback_t *_, void *buffer)
+    {
+        auto self = static_cast<BinaryRelease *>(_);
+        self->mapping.close();
+        string().swap(self->content);
+    }
+};
+
+// ArrayBuffer over file bytes, null if not found.
+static cef_v8value_t *RequireBinary(const wstring &path)
+{
+    auto release = new BinaryRelease();
+    int64 size, mtime;
+    void *data;
+    size_t length;
+
+    // Copy-on-write view, JS may write to the buffer but never to the file.
+    // The file can't be written while the view lives, so only big files are worth it.
+    if (utils::statFile(path, size, mtime) && size >= BINARY_COPY_LIMIT
+        && release->mapping.open(path, true))
+    {
+        data = const_cast<char *>(release->mapping.data());
+        length = release->mapping.size();
+    }
+    else if (utils::readFile(path, release->content))
+    {
+        data = &release->content[0];
+        length = release->content.length();
+    }
+    else
+    {
+        release->base.release(&release->base);
+        return CefV8Value_CreateNull();
+    }
+
+    return CefV8Value_CreateArrayBuffer(data, length, release);
+}
+
+static utils::WorkerPool &GetReadPool()
+{
+    static auto pool = new utils::WorkerPool(READ_THREADS, MAX_PENDING_READS);
+    return *pool;
+}
+
+static void CallFunction(cef_v8value_t *fn, cef_v8value_t *arg)
+{
+    auto result = fn->execute_function(fn, nullptr, 1, &arg);
+    if (result != nullptr)
+        result->base.release(&result->base);
+}
+
+// Read on worker, then call resolve(content or null) on the thread of context.
+static void RequireFileAsync(const wstring &path, cef_v8value_t *resolve, cef_v8value_t *reject)
+{
+    auto context = CefV8Context_GetCurrentContext();
+    auto runner = context->get_task_runner(context);
+
+    resolve->base.add_ref(&resolve->base);
+
+    bool posted = GetReadPool().post([path, context, runner, resolve]
+    {
+        // Convert here too, keep the renderer thread free.
+        auto content = LoadRequireFile(path);
+
+        runner->post_task(runner, new CefFunctionTask([context, resolve, content]
+        {
+            // Page could be gone meanwhile.
+            if (context->is_valid(context) && context->enter(context))
+            {
+                CallFunction(resolve, content != nullptr
+                    ? CefV8Value_CreateString(content.get()) : CefV8Value_CreateNull());
+                context->exit(context);
+            }
+
+            resolve->base.release(&resolve->base);
+            context->base.release(&context->base);
+        }));
+
+        runner->base.release(&runner->base);
+    });
+
+    if (!posted)
+    {
+        resolve->base.release(&resolve->base);
+        runner->base.release(&runner->base);
+        context->base.release(&context->base);
+
+        CallFunction(reject, CefV8Value_CreateString(&"Too many pending reads."_s));
+    }
+}
+
+bool HandlePlugins(const wstring &fn, const vector<cef_v8value_t *> &args, cef_v8value_t * &retval)
+{
+    if (fn == L"RequireFile")
+    {
+        if (args.size() > 0 && args[0]->is_string(args[0]))
+        {
+            if (auto content = LoadRequireFile(GetRequirePath(args[0])))
             {
-                retval = CefV8Value_CreateString(&CefStr(content));
+                retval = CefV8Value_CreateString(content.get());
                 return true;
             }
         }
@@ -78,6 +540,61 @@ bool HandlePlugins(const wstring &fn, const vector<cef_v8value_t *> &args, cef_v
         retval = CefV8Value_CreateNull();
         return true;
     }
+    else if (fn == L"RequireBinary")
+    {
+        if (args.size() > 0 && args[0]->is_string(args[0]))
+            retval = RequireBinary(GetRequirePath(args[0]));
+        else
+            retval = CefV8Value_CreateNull();
+
+        return true;
+    }
+    else if (fn == L"GetRequireCacheStats")
+    {
+        char buf[192];
+        int64 hits, misses, evictions, bytes, entries;
+        GetRequireCacheStats(hits, misses, evictions, bytes, entries);
+
+        snprintf(buf, sizeof(buf), "{\"hits\":%lld,\"misses\":%lld,\"evictions\":%lld,\"bytes\":%lld,\"entries\":%lld}",
+            hits, misses, evictions, bytes, entries);
+
+        retval = CefV8Value_CreateString(&CefStr(buf, strlen(buf)));
+        return true;
+    }
+    else if (fn == L"RequireFileAsync")
+    {
+        if (args.size() >= 3 && args[0]->is_string(args[0])
+            && args[1]->is_function(args[1]) && args[2]->is_function(args[2]))
+        {
+            RequireFileAsync(GetRequirePath(args[0]), args[1], args[2]);
+        }
+
+        return true;
+    }
+    else if (fn == L"ReportPluginLoad")
+    {
+        // Metrics live in browser process.
+        if (args.size() >= 4 && args[0]->is_string(args[0]) && args[1]->is_bool(args[1])
+            && args[2]->is_double(args[2]) && args[3]->is_string(args[3]))
+        {
+            auto context = CefV8Context_GetCurrentContext();
+            auto frame = context->get_frame(context);
+
+            auto message = CefProcessMessage_Create(&"__plugin_loaded"_s);
+            auto list = message->get_argument_list(message);
+
+            CefScopedStr name{ args[0]->get_string_value(args[0]) };
+            CefScopedStr error{ args[3]->get_string_value(args[3]) };
+
+            list->set_string(list, 0, &name);
+            list->set_bool(list, 1, args[1]->get_bool_value(args[1]));
+            list->set_double(list, 2, args[2]->get_double_value(args[2]));
+            list->set_string(list, 3, &error);
+            frame->send_process_message(frame, PID_BROWSER, message);
+        }
+
+        return true;
+    }
 
     return false;
 }
\ No newline at end of file
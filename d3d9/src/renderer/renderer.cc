@@ -67,6 +67,33 @@ private:
             utils::openFilesExplorer(config::getPluginsDir());
             return true;
         }
+        else if (fn == L"GetMetricsURL")
+        {
+            // Metrics live in browser process, served by internal server.
+            wstring url = L"http://127.0.0.1:";
+            url.append(std::to_wstring(server_port_));
+            url.append(L"/metrics");
+
+            *retval = CefV8Value_CreateString(&CefStr(url));
+            return true;
+        }
+        else if (fn == L"TracePlugin")
+        {
+            // phase 'b' returns span id, 'e' ends it.
+            if (args.size() >= 2 && args[0]->is_string(args[0]) && args[1]->is_string(args[1]))
+            {
+                CefScopedStr phase{ args[0]->get_string_value(args[0]) };
+                CefScopedStr name{ args[1]->get_string_value(args[1]) };
+                string span = "import " + utils::toNarrow(name.cstr());
+
+                if (phase.equal(L"b"))
+                    *retval = CefV8Value_CreateInt(static_cast<int32_t>(trace::asyncBegin(span)));
+                else if (args.size() >= 3 && args[2]->is_int(args[2]))
+                    trace::asyncEnd(span, static_cast<uint64_t>(args[2]->get_int_value(args[2])));
+            }
+
+            return true;
+        }
         else if (HandlePlugins(fn, args, *retval))
             return true;
         else if (HandleDataStore(fn, args, *retval))
@@ -106,6 +133,7 @@ static void CEF_CALLBACK Hooked_OnContextCreated(
     struct _cef_frame_t* frame,
     struct _cef_v8context_t* context)
 {
+    TRACE_SPAN("OnContextCreated");
     Old_OnContextCreated(self, browser, frame, context);
 
     if (is_main_)
@@ -176,6 +204,22 @@ static int CEF_CALLBACK Hooked_OnProcessMessageReceived(
             server_port_ = args->get_int(args, 0);
             return 1;
         }
+        else if (msg == L"__plugin_changed")
+        {
+            auto args = message->get_argument_list(message);
+            CefScopedStr name{ args->get_string(args, 0) };
+            CefScopedStr url{ args->get_string(args, 1) };
+
+            // Relay to plugins, names and URLs are safe in JS string (no quote or backslash).
+            wstring script = L"window.dispatchEvent(new CustomEvent('plugin-changed', { detail: { name: \"";
+            script.append(name.cstr());
+            script.append(L"\", url: ");
+            script.append(url.empty() ? L"null" : L"\"" + url.cstr() + L"\"");
+            script.append(L" } }));");
+
+            frame->execute_java_script(frame, &CefStr(script), &""_s, 1);
+            return 1;
+        }
         else if (msg == L"__auth_response")
         {
             auto args = message->get_argument_list(message);
@@ -194,6 +238,9 @@ static int CEF_CALLBACK Hooked_OnProcessMessageReceived(
 
 static int Hooked_CefExecuteProcess(const cef_main_args_t* args, cef_app_t* app, void* windows_sandbox_info)
 {
+    // First call out of DllMain.
+    trace::start();
+
     // Hook RenderProcessHandler.
     static auto Old_GetRenderProcessHandler = app->get_render_process_handler;
     app->get_render_process_handler = [](cef_app_t* self) -> cef_render_process_handler_t*
@@ -0,0 +1,382 @@
+#include "../common.h"
+#include <algorithm>
+#include <sstream>
+
+// RENDERER PROCESS ONLY.
+
+// Plugins dir scan behind the manifest, see renderer/loader.cc for how it's used.
+
+static const char MANIFEST_MAGIC[] = "LLPM 3";
+static const size_t MANIFEST_FIELDS = 11;
+static const wchar_t SHARED_PREFIX[] = L"_shared/";
+static const size_t SCAN_TASKS = 4;
+
+bool plugins::isPackName(const wstring &name)
+{
+    return utils::strEndWith(name, L".llpk");
+}
+
+bool plugins::isSharedName(const wstring &name)
+{
+    return utils::strStartWith(name, SHARED_PREFIX);
+}
+
+wstring plugins::getPluginName(const wstring &name)
+{
+    if (isSharedName(name))
+        return name.substr(COUNT_OF(SHARED_PREFIX) - 1);
+
+    return isPackName(name) ? name.substr(0, name.length() - 5) : name;
+}
+
+static vector<string> SplitFields(const string &line)
+{
+    vector<string> fields{};
+    size_t start = 0;
+
+    while (start <= line.length())
+    {
+        size_t end = line.find('\t', start);
+        if (end == string::npos) end = line.length();
+
+        fields.push_back(line.substr(start, end - start));
+        start = end + 1;
+    }
+
+    return fields;
+}
+
+// Text file, header then one tab separated entry per line:
+//   LLPM 3 <plugins dir mtime>
+//   <name> <dir mtime> <valid> <size> <mtime> <hash> <meta mtime> <priority> <route> <selector> <module>
+bool plugins::parseManifest(const string &content, Manifest &manifest)
+{
+    std::istringstream stream(content);
+    string line{};
+
+    if (!std::getline(stream, line) || line.compare(0, sizeof(MANIFEST_MAGIC) - 1, MANIFEST_MAGIC) != 0)
+        return false;
+
+    manifest.dir_mtime = strtoll(line.c_str() + sizeof(MANIFEST_MAGIC), nullptr, 10);
+    manifest.entries.clear();
+
+    while (std::getline(stream, line))
+    {
+        auto fields = SplitFields(line);
+        if (fields.size() != MANIFEST_FIELDS)
+            continue;
+
+        ManifestEntry entry{};
+        entry.name = utils::toWide(fields[0]);
+        entry.dir_mtime = strtoll(fields[1].c_str(), nullptr, 10);
+        entry.valid = fields[2] == "1";
+        entry.size = strtoll(fields[3].c_str(), nullptr, 10);
+        entry.mtime = strtoll(fields[4].c_str(), nullptr, 10);
+        entry.hash = strtoull(fields[5].c_str(), nullptr, 16);
+        entry.meta_mtime = strtoll(fields[6].c_str(), nullptr, 10);
+        entry.priority = std::max<int>(PRIORITY_CRITICAL, std::min<int>(atoi(fields[7].c_str()), PRIORITY_IDLE));
+        entry.route = utils::toWide(fields[8]);
+        entry.selector = utils::toWide(fields[9]);
+        entry.module = utils::toWide(fields[10]);
+        manifest.entries.push_back(entry);
+    }
+
+    return true;
+}
+
+string plugins::formatManifest(const Manifest &manifest)
+{
+    char buffer[128];
+    snprintf(buffer, sizeof(buffer), "%s %lld\n", MANIFEST_MAGIC, static_cast<long long>(manifest.dir_mtime));
+    string content = buffer;
+
+    for (const auto &entry : manifest.entries)
+    {
+        snprintf(buffer, sizeof(buffer), "\t%lld\t%d\t%lld\t%lld\t%016llx\t%lld\t%d\t",
+            static_cast<long long>(entry.dir_mtime), entry.valid ? 1 : 0,
+            static_cast<long long>(entry.size), static_cast<long long>(entry.mtime),
+            static_cast<unsigned long long>(entry.hash), static_cast<long long>(entry.meta_mtime), entry.priority);
+
+        content.append(utils::toNarrow(entry.name)).append(buffer)
+            .append(utils::toNarrow(entry.route)).append("\t")
+            .append(utils::toNarrow(entry.selector)).append("\t")
+            .append(utils::toNarrow(entry.module)).append("\n");
+    }
+
+    return content;
+}
+
+static bool SameEntry(const plugins::ManifestEntry &a, const plugins::ManifestEntry &b)
+{
+    return a.name == b.name && a.dir_mtime == b.dir_mtime && a.valid == b.valid
+        && a.size == b.size && a.mtime == b.mtime && a.hash == b.hash && a.meta_mtime == b.meta_mtime
+        && a.priority == b.priority && a.route == b.route && a.selector == b.selector && a.module == b.module;
+}
+
+const plugins::ManifestEntry *plugins::findEntry(const Manifest &manifest, const wstring &name)
+{
+    auto it = std::lower_bound(manifest.entries.begin(), manifest.entries.end(), name,
+        [](const ManifestEntry &entry, const wstring &name) { return entry.name < name; });
+
+    return it != manifest.entries.end() && it->name == name ? &*it : nullptr;
+}
+
+// Entry module of plugin is still what manifest has hashed, by size and mtime.
+bool plugins::isEntryFresh(const wstring &dir, const ManifestEntry &entry)
+{
+    int64 size, mtime;
+    wstring file = dir + L"\\" + entry.name;
+
+    if (!isPackName(entry.name))
+        file.append(L"\\index.js");
+
+    return utils::statFile(file, size, mtime) && size == entry.size && mtime == entry.mtime;
+}
+
+// Check package.json of plugin folder, reparse when it's changed.
+static void ScanMeta(plugins::Host &host, const wstring &folder, const plugins::ManifestEntry *known, plugins::ManifestEntry &out)
+{
+    int64 size;
+    auto file = folder + L"\\package.json";
+
+    if (!utils::statFile(file, size, out.meta_mtime))
+        return;
+
+    if (known != nullptr && known->meta_mtime == out.meta_mtime)
+    {
+        out.priority = known->priority;
+        out.route = known->route;
+        out.selector = known->selector;
+        return;
+    }
+
+    string content{};
+    if (utils::readFile(file, content))
+        host.parseMeta(content.data(), content.length(), out);
+}
+
+// Find entry module of shared library, it moves only with package.json or folder listing.
+static void ScanShared(plugins::Host &host, const wstring &dir, const wstring &name,
+    const plugins::ManifestEntry *known, plugins::ManifestEntry &out)
+{
+    int64 size;
+    wstring folder = dir + L"\\" + name;
+
+    if (!utils::statDir(folder, out.dir_mtime))
+        return;
+
+    utils::statFile(folder + L"\\package.json", size, out.meta_mtime);
+
+    if (known != nullptr && known->dir_mtime == out.dir_mtime && known->meta_mtime == out.meta_mtime)
+    {
+        out.valid = known->valid;
+        out.module = known->module;
+        return;
+    }
+
+    out.module = host.getPackageEntry(folder);
+    out.valid = !out.module.empty();
+}
+
+// Check entry module of plugin folder or pack, hash is reused while it's unchanged.
+void plugins::scanEntry(Host &host, const wstring &dir, const wstring &name,
+    const ManifestEntry *known, ManifestEntry &out)
+{
+    bool packed = isPackName(name);
+    wstring file = dir + L"\\" + name;
+
+    out = ManifestEntry{ name, 0, false, 0, 0, 0, 0, PRIORITY_NORMAL, L"", L"", L"" };
+
+    if (isSharedName(name))
+        return ScanShared(host, dir, name, known, out);
+
+    if (packed)
+    {
+        // Unpacked folder takes precedence.
+        if (utils::dirExist(dir + L"\\" + getPluginName(name)))
+            return;
+    }
+    else
+    {
+        if (!utils::statDir(file, out.dir_mtime))
+            return;
+
+        // No index.js inside, same as last time. Keep all of it, or the manifest
+        // would be rewritten each launch for such folder with package.json.
+        if (known != nullptr && !known->valid && known->dir_mtime == out.dir_mtime)
+        {
+            out = *known;
+            return;
+        }
+
+        ScanMeta(host, file, known, out);
+        file.append(L"\\index.js");
+    }
+
+    if (!utils::statFile(file, out.size, out.mtime))
+        return;
+
+    if (known != nullptr && known->valid && known->size == out.size && known->mtime == out.mtime)
+    {
+        out.hash = known->hash;
+        out.valid = true;
+
+        // Pack is unchanged, so is its package.json.
+        if (packed)
+        {
+            out.priority = known->priority;
+            out.route = known->route;
+            out.selector = known->selector;
+        }
+        return;
+    }
+
+    utils::FileMapping mapping{};
+    const char *data;
+    size_t length;
+
+    if (!mapping.open(file))
+        return;
+
+    if (!packed)
+    {
+        data = mapping.data();
+        length = mapping.size();
+    }
+    else if (!utils::findPackEntry(mapping.data(), mapping.size(), "index.js", data, length))
+    {
+        return;
+    }
+
+    out.hash = utils::hashContent(data, length);
+    out.valid = true;
+
+    const char *meta;
+    size_t meta_length;
+
+    if (packed && utils::findPackEntry(mapping.data(), mapping.size(), "package.json", meta, meta_length))
+        host.parseMeta(meta, meta_length, out);
+}
+
+// Add library and its subpath packages with own package.json, like preact/hooks.
+static void AddShared(const wstring &shared, const wstring &lib, vector<wstring> &names)
+{
+    auto folder = shared + L"\\" + lib;
+    names.push_back(SHARED_PREFIX + lib);
+
+    for (const auto &sub : utils::readDir(folder + L"\\*"))
+    {
+        if (sub[0] != '.' && sub != L"node_modules" && utils::fileExist(folder + L"\\" + sub + L"\\package.json"))
+            names.push_back(SHARED_PREFIX + lib + L"/" + sub);
+    }
+}
+
+// Library folders in plugins/_shared, scoped ones as @scope/name.
+static void ListShared(const wstring &dir, vector<wstring> &names)
+{
+    auto shared = dir + L"\\_shared";
+
+    for (const auto &name : utils::readDir(shared + L"\\*"))
+    {
+        if (name[0] == '.' || !utils::dirExist(shared + L"\\" + name))
+            continue;
+
+        if (name[0] != '@')
+        {
+            AddShared(shared, name, names);
+            continue;
+        }
+
+        for (const auto &sub : utils::readDir(shared + L"\\" + name + L"\\*"))
+        {
+            if (sub[0] != '.' && utils::dirExist(shared + L"\\" + name + L"\\" + sub))
+                AddShared(shared, name + L"/" + sub, names);
+        }
+    }
+}
+
+struct PluginsScan
+{
+    plugins::Host *host;
+    wstring dir;
+    plugins::Manifest known;
+    vector<wstring> names;
+    vector<plugins::ManifestEntry> entries;
+    std::atomic<size_t> remaining;
+    std::function<void(plugins::Manifest &, bool)> done;
+};
+
+static void FinishScan(PluginsScan &scan)
+{
+    plugins::Manifest manifest{};
+    utils::statDir(scan.dir, manifest.dir_mtime);
+
+    bool changed = manifest.dir_mtime != scan.known.dir_mtime
+        || scan.entries.size() != scan.known.entries.size();
+
+    for (size_t i = 0; i < scan.entries.size(); i++)
+    {
+        changed = changed || !SameEntry(scan.entries[i], scan.known.entries[i]);
+        manifest.entries.push_back(std::move(scan.entries[i]));
+    }
+
+    scan.done(manifest, changed);
+}
+
+// Revalidate known plugins on workers, one stride of names per task.
+void plugins::scan(Host &host, const wstring &dir, const Manifest &known,
+    std::function<void(Manifest &, bool)> done, bool wait)
+{
+    auto scan = std::make_shared<PluginsScan>();
+    scan->host = &host;
+    scan->dir = dir;
+    scan->known = known;
+    scan->done = std::move(done);
+
+    int64 dir_mtime = 0;
+    utils::statDir(scan->dir, dir_mtime);
+
+    // No entry added or removed, skip listing.
+    if (dir_mtime != 0 && dir_mtime == known.dir_mtime)
+    {
+        for (const auto &entry : known.entries)
+            if (!isSharedName(entry.name)) scan->names.push_back(entry.name);
+    }
+    else
+    {
+        for (const auto &name : utils::readDir(scan->dir + L"\\*"))
+        {
+            // Skip name starts with underscore or dot.
+            if (name[0] != '_' && name[0] != '.')
+                scan->names.push_back(name);
+        }
+    }
+
+    // Shared folder changes don't touch plugins dir, always list it.
+    ListShared(scan->dir, scan->names);
+    std::sort(scan->names.begin(), scan->names.end());
+
+    size_t count = scan->names.size();
+    size_t tasks = std::max<size_t>(1, std::min(SCAN_TASKS, count));
+
+    scan->entries.resize(count);
+    scan->remaining = tasks;
+
+    for (size_t t = 0; t < tasks; t++)
+    {
+        auto task = [scan, t, tasks]
+        {
+            for (size_t i = t; i < scan->names.size(); i += tasks)
+            {
+                const auto &name = scan->names[i];
+                plugins::scanEntry(*scan->host, scan->dir, name, findEntry(scan->known, name), scan->entries[i]);
+            }
+
+            if (--scan->remaining == 0)
+                FinishScan(*scan);
+        };
+
+        if (wait || !host.post(task))
+            task();
+    }
+}
\ No newline at end of file
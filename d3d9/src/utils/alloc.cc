@@ -0,0 +1,52 @@
+#include "../common.h"
+
+// Build with LL_ALLOC_STATS to count heap allocations per thread, used to
+// check that hot paths don't allocate. Opt-in, /p:AllocStats=true for msbuild,
+// as it bypasses the CRT debug heap. tests/bench_read links it too.
+
+#ifdef LL_ALLOC_STATS
+#include <stdlib.h>
+#include <new>
+
+static thread_local int64 alloc_count_ = 0;
+
+int64 utils::allocCount()
+{
+    return alloc_count_;
+}
+
+void *operator new(size_t size)
+{
+    ++alloc_count_;
+
+    if (void *p = malloc(size ? size : 1))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete[](void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+    free(p);
+}
+#endif
\ No newline at end of file
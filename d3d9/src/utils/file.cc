@@ -1,6 +1,16 @@
-#include "../internal.h"
+#include "../common.h"
 #include <fstream>
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <fnmatch.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef _WIN32
+
 bool utils::dirExist(const std::wstring &path)
 {
     DWORD attr = GetFileAttributesW(path.c_str());
@@ -36,6 +46,40 @@ bool utils::readFile(const std::wstring &path, std::string &out)
     return result;
 }
 
+bool utils::statFile(const std::wstring &path, int64 &size, int64 &mtime)
+{
+    WIN32_FILE_ATTRIBUTE_DATA data;
+
+    if (!GetFileAttributesExW(path.c_str(), GetFileExInfoStandard, &data))
+        return false;
+
+    if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+        return false;
+
+    size = (static_cast<int64>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+    mtime = (static_cast<int64>(data.ftLastWriteTime.dwHighDateTime) << 32)
+        | data.ftLastWriteTime.dwLowDateTime;
+
+    return true;
+}
+
+// Folder mtime changes when its entries are added, removed or renamed.
+bool utils::statDir(const std::wstring &path, int64 &mtime)
+{
+    WIN32_FILE_ATTRIBUTE_DATA data;
+
+    if (!GetFileAttributesExW(path.c_str(), GetFileExInfoStandard, &data))
+        return false;
+
+    if (!(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+        return false;
+
+    mtime = (static_cast<int64>(data.ftLastWriteTime.dwHighDateTime) << 32)
+        | data.ftLastWriteTime.dwLowDateTime;
+
+    return true;
+}
+
 vector<wstring> utils::readDir(const std::wstring &dir)
 {
     vector<wstring> files{};
@@ -53,4 +97,123 @@ vector<wstring> utils::readDir(const std::wstring &dir)
     }
 
     return files;
+}
+
+#else
+
+// Paths are '\\' separated like on Windows.
+static string NativePath(const wstring &path)
+{
+    auto native = utils::toNarrow(path);
+    for (auto &c : native)
+        if (c == '\\') c = '/';
+    return native;
+}
+
+// Same unit as FILETIME, 100ns.
+static int64 StatTime(const struct stat &st)
+{
+    return static_cast<int64>(st.st_mtim.tv_sec) * 10000000 + st.st_mtim.tv_nsec / 100;
+}
+
+bool utils::dirExist(const std::wstring &path)
+{
+    struct stat st;
+    return stat(NativePath(path).c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+bool utils::fileExist(const std::wstring &path)
+{
+    struct stat st;
+    return stat(NativePath(path).c_str(), &st) == 0 && !S_ISDIR(st.st_mode);
+}
+
+bool utils::readFile(const std::wstring &path, std::string &out)
+{
+    std::ifstream input(NativePath(path), std::ios::binary);
+
+    if (input.fail())
+        return false;
+
+    out.assign((std::istreambuf_iterator<char>(input)),
+        (std::istreambuf_iterator<char>()));
+    return true;
+}
+
+bool utils::statFile(const std::wstring &path, int64 &size, int64 &mtime)
+{
+    struct stat st;
+
+    if (stat(NativePath(path).c_str(), &st) != 0 || S_ISDIR(st.st_mode))
+        return false;
+
+    size = st.st_size;
+    mtime = StatTime(st);
+    return true;
+}
+
+bool utils::statDir(const std::wstring &path, int64 &mtime)
+{
+    struct stat st;
+
+    if (stat(NativePath(path).c_str(), &st) != 0 || !S_ISDIR(st.st_mode))
+        return false;
+
+    mtime = StatTime(st);
+    return true;
+}
+
+// Pattern in last component like FindFirstFileW, "dir\\*".
+vector<wstring> utils::readDir(const std::wstring &dir)
+{
+    vector<wstring> files{};
+
+    auto native = NativePath(dir);
+    size_t slash = native.find_last_of('/');
+    string folder = slash == string::npos ? "." : native.substr(0, slash);
+    string pattern = native.substr(slash + 1);
+
+    if (DIR *handle = opendir(folder.c_str()))
+    {
+        while (dirent *entry = readdir(handle))
+        {
+            if (fnmatch(pattern.c_str(), entry->d_name, 0) == 0)
+                files.push_back(toWide(entry->d_name));
+        }
+
+        closedir(handle);
+    }
+
+    return files;
+}
+
+#endif
+
+// Like bundlers do: first candidate ("module" or "main" of package.json) found,
+// then index.js; entry without extension is tried as .js file then folder.
+wstring utils::findPackageEntry(const wstring &folder, vector<wstring> candidates)
+{
+    candidates.push_back(L"index.js");
+
+    for (auto entry : candidates)
+    {
+        for (auto &c : entry)
+            if (c == L'\\') c = L'/';
+        while (strStartWith(entry, L"./"))
+            entry.erase(0, 2);
+        while (!entry.empty() && entry.back() == L'/')
+            entry.pop_back();
+
+        // Stay inside package.
+        if (entry.empty() || entry[0] == L'/' || strContain(entry, L".."))
+            continue;
+
+        for (auto suffix : { L"", L".js", L"/index.js" })
+        {
+            if (fileExist(folder + L"\\" + entry + suffix))
+                return entry + suffix;
+        }
+    }
+
+    return L"";
 }
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include "../common.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+utils::FileMapping::FileMapping()
+    : file_(INVALID_HANDLE_VALUE), section_(NULL), data_(nullptr), size_(0)
+{
+}
+
+utils::FileMapping::~FileMapping()
+{
+    close();
+}
+
+bool utils::FileMapping::open(const std::wstring &path, bool copy_on_write)
+{
+    close();
+
+    // Let editors keep saving while the file is mapped. Pages of copy-on-write view
+    // are shared with the file until written, deny writes there to keep a snapshot.
+    file_ = CreateFileW(path.c_str(), GENERIC_READ,
+        copy_on_write ? FILE_SHARE_READ | FILE_SHARE_DELETE : FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+    if (file_ == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file_, &size) || size.QuadPart > SIZE_MAX)
+    {
+        close();
+        return false;
+    }
+
+    // Empty file cannot be mapped.
+    if (size.QuadPart == 0)
+    {
+        data_ = "";
+        return true;
+    }
+
+    section_ = CreateFileMappingW(file_, NULL, copy_on_write ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, NULL);
+    if (section_ != NULL)
+        data_ = static_cast<const char *>(MapViewOfFile(section_, copy_on_write ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0));
+
+    if (data_ == nullptr)
+    {
+        // Likely out of address space, let caller fall back.
+        close();
+        return false;
+    }
+
+    size_ = static_cast<size_t>(size.QuadPart);
+    return true;
+}
+
+void utils::FileMapping::close()
+{
+    if (data_ != nullptr && size_ > 0)
+        UnmapViewOfFile(data_);
+    if (section_ != NULL)
+        CloseHandle(section_);
+    if (file_ != INVALID_HANDLE_VALUE)
+        CloseHandle(file_);
+
+    file_ = INVALID_HANDLE_VALUE;
+    section_ = NULL;
+    data_ = nullptr;
+    size_ = 0;
+}
+
+#else
+
+utils::FileMapping::FileMapping()
+    : data_(nullptr), size_(0)
+{
+}
+
+utils::FileMapping::~FileMapping()
+{
+    close();
+}
+
+// Paths are '\\' separated like on Windows.
+bool utils::FileMapping::open(const std::wstring &path, bool copy_on_write)
+{
+    close();
+
+    auto native = toNarrow(path);
+    for (auto &c : native)
+        if (c == '\\') c = '/';
+
+    int fd = ::open(native.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)
+        || static_cast<uint64_t>(st.st_size) > SIZE_MAX)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    // Empty file cannot be mapped.
+    if (st.st_size == 0)
+    {
+        ::close(fd);
+        data_ = "";
+        return true;
+    }
+
+    // No deny-write here, other writes may show through pages not yet copied.
+    void *view = mmap(nullptr, static_cast<size_t>(st.st_size),
+        copy_on_write ? PROT_READ | PROT_WRITE : PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // View stays valid without the descriptor.
+    ::close(fd);
+
+    if (view == MAP_FAILED)
+        return false;
+
+    data_ = static_cast<const char *>(view);
+    size_ = static_cast<size_t>(st.st_size);
+    return true;
+}
+
+void utils::FileMapping::close()
+{
+    if (data_ != nullptr && size_ > 0)
+        munmap(const_cast<char *>(data_), size_);
+
+    data_ = nullptr;
+    size_ = 0;
+}
+
+#endif
\ No newline at end of file
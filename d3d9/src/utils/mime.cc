@@ -0,0 +1,122 @@
+#include "../common.h"
+#include <string.h>
+
+// Compile-time MIME table for common web assets, no allocation or libcef call.
+
+struct MimeType
+{
+    const char *ext;
+    const char *mime;
+};
+
+static constexpr MimeType mime_types[] =
+{
+    // images
+    { "bmp", "image/bmp" },
+    { "png", "image/png" },
+    { "jpg", "image/jpeg" },
+    { "jpeg", "image/jpeg" },
+    { "jfif", "image/jpeg" },
+    { "pjpeg", "image/jpeg" },
+    { "pjp", "image/jpeg" },
+    { "gif", "image/gif" },
+    { "svg", "image/svg+xml" },
+    { "ico", "image/x-icon" },
+    { "webp", "image/webp" },
+    { "avif", "image/avif" },
+
+    // media
+    { "mp4", "video/mp4" },
+    { "webm", "video/webm" },
+    { "ogg", "audio/ogg" },
+    { "mp3", "audio/mpeg" },
+    { "wav", "audio/wav" },
+    { "flac", "audio/flac" },
+    { "aac", "audio/aac" },
+
+    // fonts
+    { "woff", "font/woff" },
+    { "woff2", "font/woff2" },
+    { "eot", "application/vnd.ms-fontobject" },
+    { "ttf", "font/ttf" },
+    { "otf", "font/otf" },
+
+    // web
+    { "css", "text/css" },
+    { "js", "text/javascript" },
+    { "json", "application/json" },
+    { "html", "text/html" },
+    { "wasm", "application/wasm" },
+};
+
+static const size_t MIME_TABLE_SIZE = 64;
+static const size_t MIME_MAX_EXT = 8;
+
+static constexpr size_t MimeExtLength(const char *ext)
+{
+    size_t n = 0;
+    while (ext[n] != 0) n++;
+    return n;
+}
+
+// Perfect for the table above, checked below at compile time.
+static constexpr size_t MimeHash(const char *ext, size_t length)
+{
+    return (length + 4 * ext[0] + ext[length - 1] + 15 * ext[length / 2]) & (MIME_TABLE_SIZE - 1);
+}
+
+struct MimeTable
+{
+    int slots[MIME_TABLE_SIZE];
+    bool perfect;
+};
+
+static constexpr MimeTable BuildMimeTable()
+{
+    MimeTable table{ {}, true };
+
+    for (size_t i = 0; i < MIME_TABLE_SIZE; i++)
+        table.slots[i] = -1;
+
+    for (size_t i = 0; i < COUNT_OF(mime_types); i++)
+    {
+        const char *ext = mime_types[i].ext;
+        size_t hash = MimeHash(ext, MimeExtLength(ext));
+
+        if (table.slots[hash] != -1)
+            table.perfect = false;
+        table.slots[hash] = static_cast<int>(i);
+    }
+
+    return table;
+}
+
+static constexpr MimeTable mime_table = BuildMimeTable();
+static_assert(mime_table.perfect, "MIME table has collisions, tune MimeHash.");
+
+// Case-insensitive lookup by extension without dot, null if unknown.
+const char *utils::getMimeType(const wchar_t *ext, size_t length)
+{
+    char lower[MIME_MAX_EXT];
+
+    if (length == 0 || length > MIME_MAX_EXT)
+        return nullptr;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        wchar_t c = ext[i];
+        if (c >= L'A' && c <= L'Z') c += L'a' - L'A';
+        if (c >= 0x80) return nullptr;
+        lower[i] = static_cast<char>(c);
+    }
+
+    int slot = mime_table.slots[MimeHash(lower, length)];
+    if (slot < 0)
+        return nullptr;
+
+    const auto &type = mime_types[slot];
+    if (MimeExtLength(type.ext) != length || memcmp(type.ext, lower, length) != 0)
+        return nullptr;
+
+    return type.mime;
+}
\ No newline at end of file
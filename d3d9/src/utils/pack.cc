@@ -0,0 +1,163 @@
+#include "../common.h"
+#include <string.h>
+#include <algorithm>
+
+// Plugin pack (.llpk), all integers are little-endian uint32:
+//
+//   header   "LLPK", version, entry count, reserved
+//   entries  name offset, name length, data offset, data size
+//            sorted by name, offsets are from start of file
+//   names    UTF-8 lower-case paths relative to plugin folder, '/' separated
+//   data     raw file contents
+//
+// Entries are never compressed, so they are served straight from the mapped
+// view. Reserved stays 0.
+
+static const char PACK_MAGIC[4] = { 'L', 'L', 'P', 'K' };
+static const uint32_t PACK_VERSION = 1;
+
+struct PackHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t count;
+    uint32_t reserved;
+};
+
+struct PackIndexEntry
+{
+    uint32_t name_offset;
+    uint32_t name_length;
+    uint32_t data_offset;
+    uint32_t data_size;
+};
+
+static bool ReadPackIndex(const char *pack, size_t size, const PackIndexEntry *&entries, uint32_t &count)
+{
+    if (size < sizeof(PackHeader))
+        return false;
+
+    auto header = reinterpret_cast<const PackHeader *>(pack);
+    if (memcmp(header->magic, PACK_MAGIC, sizeof(PACK_MAGIC)) != 0
+        || header->version != PACK_VERSION
+        || header->count > (size - sizeof(PackHeader)) / sizeof(PackIndexEntry))
+        return false;
+
+    entries = reinterpret_cast<const PackIndexEntry *>(pack + sizeof(PackHeader));
+    count = header->count;
+    return true;
+}
+
+static bool ValidEntry(const PackIndexEntry &entry, size_t size)
+{
+    return entry.name_offset <= size && entry.name_length <= size - entry.name_offset
+        && entry.data_offset <= size && entry.data_size <= size - entry.data_offset;
+}
+
+bool utils::readPack(const char *pack, size_t size, vector<PackEntry> &out)
+{
+    const PackIndexEntry *entries;
+    uint32_t count;
+
+    if (!ReadPackIndex(pack, size, entries, count))
+        return false;
+
+    out.clear();
+    out.reserve(count);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (!ValidEntry(entries[i], size))
+            return false;
+
+        out.push_back(PackEntry{
+            string(pack + entries[i].name_offset, entries[i].name_length),
+            pack + entries[i].data_offset,
+            entries[i].data_size
+        });
+    }
+
+    return true;
+}
+
+bool utils::findPackEntry(const char *pack, size_t size, const string &name, const char *&data, size_t &length)
+{
+    const PackIndexEntry *entries;
+    uint32_t count;
+
+    if (!ReadPackIndex(pack, size, entries, count))
+        return false;
+
+    // Binary search sorted names.
+    uint32_t lo = 0, hi = count;
+    while (lo < hi)
+    {
+        uint32_t mid = lo + (hi - lo) / 2;
+        const auto &entry = entries[mid];
+
+        if (!ValidEntry(entry, size))
+            return false;
+
+        int cmp = name.compare(0, string::npos, pack + entry.name_offset, entry.name_length);
+        if (cmp == 0)
+        {
+            data = pack + entry.data_offset;
+            length = entry.data_size;
+            return true;
+        }
+
+        if (cmp < 0) hi = mid;
+        else lo = mid + 1;
+    }
+
+    return false;
+}
+
+bool utils::writePack(vector<PackEntry> entries, string &out)
+{
+    std::sort(entries.begin(), entries.end(),
+        [](const PackEntry &a, const PackEntry &b) { return a.name < b.name; });
+
+    size_t names_offset = sizeof(PackHeader) + entries.size() * sizeof(PackIndexEntry);
+    size_t data_offset = names_offset;
+    for (const auto &entry : entries)
+        data_offset += entry.name.length();
+
+    size_t total = data_offset;
+    for (const auto &entry : entries)
+        total += entry.size;
+
+    if (total > UINT32_MAX)
+        return false;
+
+    PackHeader header{};
+    memcpy(header.magic, PACK_MAGIC, sizeof(PACK_MAGIC));
+    header.version = PACK_VERSION;
+    header.count = static_cast<uint32_t>(entries.size());
+
+    out.clear();
+    out.reserve(total);
+    out.append(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    for (const auto &entry : entries)
+    {
+        PackIndexEntry index{
+            static_cast<uint32_t>(names_offset),
+            static_cast<uint32_t>(entry.name.length()),
+            static_cast<uint32_t>(data_offset),
+            static_cast<uint32_t>(entry.size)
+        };
+
+        out.append(reinterpret_cast<const char *>(&index), sizeof(index));
+        names_offset += entry.name.length();
+        data_offset += entry.size;
+    }
+
+    for (const auto &entry : entries)
+        out.append(entry.name);
+
+    for (const auto &entry : entries)
+        out.append(entry.data, entry.size);
+
+    return true;
+}
\ No newline at end of file
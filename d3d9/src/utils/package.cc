@@ -0,0 +1,32 @@
+#include "../internal.h"
+
+// "module" or "main" of package.json, see utils::findPackageEntry.
+wstring utils::getPackageEntry(const wstring &folder)
+{
+    vector<wstring> candidates{};
+    string content{};
+
+    if (readFile(folder + L"\\package.json", content))
+    {
+        auto value = CefParseJSON(&CefStr(content), JSON_PARSER_ALLOW_TRAILING_COMMAS);
+        auto root = value != nullptr && value->get_type(value) == VTYPE_DICTIONARY
+            ? value->get_dictionary(value) : nullptr;
+
+        if (root != nullptr)
+        {
+            for (auto key : { "module", "main" })
+            {
+                CefStr _key(key, strlen(key));
+                if (root->get_type(root, &_key) == VTYPE_STRING)
+                    candidates.push_back(CefScopedStr{ root->get_string(root, &_key) }.cstr());
+            }
+
+            root->base.release(&root->base);
+        }
+
+        if (value != nullptr)
+            value->base.release(&value->base);
+    }
+
+    return findPackageEntry(folder, candidates);
+}
\ No newline at end of file
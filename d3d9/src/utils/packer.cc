@@ -0,0 +1,103 @@
+#include "../internal.h"
+#include <cwctype>
+#include <fstream>
+
+// Packer for plugin packs, format in pack.cc.
+
+static void CollectFiles(const wstring &dir, const wstring &rel, vector<std::pair<string, wstring>> &files)
+{
+    WIN32_FIND_DATAW fd;
+    HANDLE hFind = FindFirstFileW((dir + L"\\" + rel + L"*").c_str(), &fd);
+
+    if (hFind == INVALID_HANDLE_VALUE)
+        return;
+
+    do
+    {
+        wstring name = fd.cFileName;
+        if (name == L"." || name == L"..")
+            continue;
+
+        if (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+        {
+            CollectFiles(dir, rel + name + L"\\", files);
+        }
+        else
+        {
+            wstring key = rel + name;
+            for (auto &c : key)
+                c = c == L'\\' ? L'/' : towlower(c);
+
+            files.emplace_back(utils::toNarrow(key), dir + L"\\" + rel + name);
+        }
+    } while (FindNextFileW(hFind, &fd));
+
+    FindClose(hFind);
+}
+
+// Entry for rundll32: pack a plugin folder into <folder>.llpk.
+int APIENTRY _PackPluginEntry(HWND hwnd, HINSTANCE instance, LPWSTR commandLine, int showFlag)
+{
+    int argc;
+    LPWSTR *argv = CommandLineToArgvW(commandLine, &argc);
+
+    if (argv == NULL || argc < 1)
+        return 1;
+
+    wstring dir = argv[0];
+    LocalFree(argv);
+
+    while (!dir.empty() && (dir.back() == L'\\' || dir.back() == L'/'))
+        dir.pop_back();
+
+    vector<std::pair<string, wstring>> files{};
+    if (utils::dirExist(dir))
+        CollectFiles(dir, L"", files);
+
+    vector<string> contents(files.size());
+    vector<utils::PackEntry> entries{};
+    bool ok = !files.empty();
+
+    for (size_t i = 0; ok && i < files.size(); i++)
+    {
+        ok = utils::readFile(files[i].second, contents[i]);
+        entries.push_back(utils::PackEntry{ files[i].first, contents[i].data(), contents[i].length() });
+    }
+
+    string pack{};
+    ok = ok && utils::writePack(entries, pack);
+
+    if (ok)
+    {
+        // Write to temp file then replace.
+        wstring output = dir + L".llpk";
+        wstring temp = output + L".tmp";
+
+        std::ofstream stream(temp, std::ios::binary | std::ios::trunc);
+        ok = stream.write(pack.data(), pack.length()).good();
+        stream.close();
+
+        // Running client keeps old pack mapped, so it cannot be replaced or
+        // deleted, but it can be renamed. Move it aside first, the client
+        // drops it once its watcher sees the new pack.
+        wstring old = output + L"." + std::to_wstring(GetTickCount()) + L".old";
+        bool moved = ok && utils::fileExist(output) && MoveFileW(output.c_str(), old.c_str());
+
+        ok = ok && MoveFileExW(temp.c_str(), output.c_str(), MOVEFILE_REPLACE_EXISTING);
+        if (!ok) DeleteFileW(temp.c_str());
+
+        if (moved && !ok)
+            MoveFileW(old.c_str(), output.c_str());
+        else if (moved)
+            DeleteFileW(old.c_str());
+    }
+
+    if (!ok)
+    {
+        MessageBoxW(hwnd, (L"Failed to pack plugin: " + dir).c_str(),
+            L"League Loader", MB_OK | MB_ICONWARNING);
+        return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
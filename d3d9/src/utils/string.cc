@@ -1,8 +1,10 @@
-#include "../internal.h"
+#include "../common.h"
 
 #include <locale>
 #include <codecvt>
 #include <algorithm>
+#include <cwchar>
+#include <cwctype>
 
 wstring utils::toWide(const string &str)
 {
@@ -88,4 +90,43 @@ wstring utils::encodeBase64(const wstring &str)
         out.push_back('=');
 
     return out;
+}
+
+// 64-bit FNV-1a, cheap content fingerprint.
+uint64_t utils::hashContent(const char *data, size_t size)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+// Quoted JSON string of UTF-8 str.
+void utils::appendJsonString(string &out, const string &str)
+{
+    out.push_back('"');
+    for (unsigned char c : str)
+    {
+        if (c == '"' || c == '\\')
+        {
+            out.push_back('\\');
+            out.push_back(c);
+        }
+        else if (c < 0x20)
+        {
+            char escape[8];
+            snprintf(escape, sizeof(escape), "\\u%04x", c);
+            out.append(escape);
+        }
+        else
+        {
+            out.push_back(c);
+        }
+    }
+    out.push_back('"');
 }
\ No newline at end of file
@@ -0,0 +1,172 @@
+#include "../common.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Startup timeline in Chrome trace event format, loadable by chrome://tracing or Perfetto.
+// Each hooked process writes trace-<pid>.json in loader folder, events are appended
+// as they end; the closing bracket is optional in JSON array format.
+//
+// Spans start in DllMain, where config and files must not be touched under the
+// loader lock. Events are buffered until trace::start() decides from config,
+// see utils/tracefile.cc.
+
+enum TraceState
+{
+    TRACE_PENDING = 0,
+    TRACE_ENABLED,
+    TRACE_DISABLED
+};
+
+static std::mutex mutex_;
+static FILE *file_ = nullptr;
+static std::atomic<int> state_{ TRACE_PENDING };
+static string pending_;
+static std::atomic<uint64_t> async_id_{ 0 };
+
+static unsigned long ProcessId()
+{
+#ifdef _WIN32
+    return GetCurrentProcessId();
+#else
+    return static_cast<unsigned long>(getpid());
+#endif
+}
+
+static unsigned long ThreadId()
+{
+#ifdef _WIN32
+    return GetCurrentThreadId();
+#else
+    return static_cast<unsigned long>(syscall(SYS_gettid));
+#endif
+}
+
+static void AppendEvent(string &out, const string &name, char phase, int64 ts, int64 dur, uint64_t id)
+{
+    char fields[160];
+
+    out.append("{\"name\":");
+    utils::appendJsonString(out, name);
+
+    snprintf(fields, sizeof(fields), ",\"cat\":\"loader\",\"ph\":\"%c\",\"ts\":%lld,\"pid\":%lu,\"tid\":%lu",
+        phase, static_cast<long long>(ts), ProcessId(), ThreadId());
+    out.append(fields);
+
+    if (phase == 'X')
+    {
+        snprintf(fields, sizeof(fields), ",\"dur\":%lld", static_cast<long long>(dur));
+        out.append(fields);
+    }
+    else if (phase == 'b' || phase == 'e')
+    {
+        snprintf(fields, sizeof(fields), ",\"id\":\"0x%llx\"", static_cast<unsigned long long>(id));
+        out.append(fields);
+    }
+
+    out.append("},\n");
+}
+
+static void WriteEvent(const string &event)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (state_ == TRACE_PENDING)
+    {
+        pending_.append(event);
+        return;
+    }
+
+    if (file_ == nullptr)
+        return;
+
+    // Flush every event, process could be killed anytime.
+    fwrite(event.data(), 1, event.size(), file_);
+    fflush(file_);
+}
+
+void trace::open(FILE *file, const string &process)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (state_ != TRACE_PENDING)
+        return;
+
+    if (file != nullptr)
+    {
+        string head = "[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":"
+            + std::to_string(ProcessId()) + ",\"args\":{\"name\":";
+        utils::appendJsonString(head, process);
+        head.append("}},\n").append(pending_);
+
+        fwrite(head.data(), 1, head.size(), file);
+        fflush(file);
+        file_ = file;
+    }
+
+    string().swap(pending_);
+    state_ = file != nullptr ? TRACE_ENABLED : TRACE_DISABLED;
+}
+
+// Still recording until start() has decided.
+bool trace::enabled()
+{
+    return state_ != TRACE_DISABLED;
+}
+
+void trace::complete(const string &name, int64 start, int64 duration)
+{
+    if (!enabled())
+        return;
+
+    string event{};
+    AppendEvent(event, name, 'X', start, duration, 0);
+    WriteEvent(event);
+}
+
+uint64_t trace::asyncBegin(const string &name)
+{
+    if (!enabled())
+        return 0;
+
+    uint64_t id = ++async_id_;
+
+    string event{};
+    AppendEvent(event, name, 'b', utils::tickMicros(), 0, id);
+    WriteEvent(event);
+
+    return id;
+}
+
+void trace::asyncEnd(const string &name, uint64_t id)
+{
+    if (!enabled() || id == 0)
+        return;
+
+    string event{};
+    AppendEvent(event, name, 'e', utils::tickMicros(), 0, id);
+    WriteEvent(event);
+}
+
+trace::Span::Span(const char *name)
+    : name_(name), start_(enabled() ? utils::tickMicros() : -1)
+{
+}
+
+trace::Span::~Span()
+{
+    end();
+}
+
+void trace::Span::end()
+{
+    if (start_ < 0)
+        return;
+
+    complete(name_, start_, utils::tickMicros() - start_);
+    start_ = -1;
+}
\ No newline at end of file
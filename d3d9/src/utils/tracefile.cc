@@ -0,0 +1,28 @@
+#include "../internal.h"
+#include <mutex>
+
+// Trace file of this process, trace-<pid>.json in loader folder.
+
+static std::once_flag init_;
+
+// Enabled by TraceStartup=1, call once out of DllMain.
+void trace::start()
+{
+    std::call_once(init_, []
+    {
+        FILE *file = nullptr;
+        wstring exe{};
+
+        if (config::getConfigValue(L"TraceStartup") == L"1")
+        {
+            auto path = config::getLoaderDir() + L"\\trace-" + std::to_wstring(GetCurrentProcessId()) + L".json";
+            file = _wfopen(path.c_str(), L"wb");
+
+            WCHAR _path[2048];
+            exe.assign(_path, GetModuleFileNameW(NULL, _path, _countof(_path)));
+            exe = exe.substr(exe.find_last_of(L"\\/") + 1);
+        }
+
+        open(file, utils::toNarrow(exe));
+    });
+}
\ No newline at end of file
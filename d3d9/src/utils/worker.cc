@@ -0,0 +1,68 @@
+#include "../internal.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+// Shared with workers and never freed, they outlive the pool.
+struct utils::WorkerPool::State
+{
+    std::atomic<size_t> pending;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::function<void()>> queue;
+};
+
+utils::WorkerPool::WorkerPool(size_t threads, size_t capacity)
+    : state_(new State{}), capacity_(capacity)
+{
+    state_->pending = 0;
+
+    for (size_t i = 0; i < threads; i++)
+        CloseHandle(CreateThread(NULL, 0, worker, state_, 0, NULL));
+}
+
+bool utils::WorkerPool::post(std::function<void()> task)
+{
+    // Reserve a slot first, so the bound holds under contention.
+    if (++state_->pending > capacity_)
+    {
+        --state_->pending;
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        state_->queue.push_back(std::move(task));
+    }
+
+    state_->cv.notify_one();
+    return true;
+}
+
+size_t utils::WorkerPool::pending() const
+{
+    return state_->pending;
+}
+
+DWORD WINAPI utils::WorkerPool::worker(LPVOID param)
+{
+    auto state = static_cast<State *>(param);
+
+    while (true)
+    {
+        std::function<void()> task;
+
+        {
+            std::unique_lock<std::mutex> lock(state->mutex);
+            state->cv.wait(lock, [state] { return !state->queue.empty(); });
+
+            task = std::move(state->queue.front());
+            state->queue.pop_front();
+        }
+
+        task();
+        --state->pending;
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,28 @@
+#include "import_corpus.h"
+
+// Plugin request classification per request, hand-written tokenizer
+// against the std::regex path it replaced.
+//
+//   bench_import [rounds]
+
+int main(int argc, char **argv)
+{
+    size_t rounds = argc > 1 ? static_cast<size_t>(atoi(argv[1])) : 50;
+    auto corpus = BuildImportCorpus();
+    size_t n = corpus.size();
+
+    double regex = BenchNanos(rounds * n, [&](size_t i)
+    {
+        KeepValue(RegexClassify(corpus[i % n]));
+    });
+
+    double tokenizer = BenchNanos(rounds * n, [&](size_t i)
+    {
+        KeepValue(Classify(corpus[i % n]));
+    });
+
+    printf("corpus: %zu requests x %zu rounds\n", n, rounds);
+    printf("regex:     %8.1f ns/request\n", regex);
+    printf("tokenizer: %8.1f ns/request\n", tokenizer);
+    return 0;
+}
\ No newline at end of file
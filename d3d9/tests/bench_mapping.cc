@@ -0,0 +1,60 @@
+#include "check.h"
+#include <string.h>
+#include <algorithm>
+
+// Serving a large media file into CEF sized buffers: one memcpy per read from
+// a mapped view, against stream reads through stdio like the CEF file reader.
+//
+//   bench_mapping [size in MB]
+
+static const size_t READ_SIZE = 64 * 1024;
+
+int main(int argc, char **argv)
+{
+    size_t mb = argc > 1 ? static_cast<size_t>(atoi(argv[1])) : 256;
+    auto dir = MakeTestDir("bench_mapping");
+    auto path = dir + "/media.mp4";
+
+    string content(mb * 1024 * 1024, 'm');
+    if (!WriteTestFile(path, content))
+        return 1;
+    string().swap(content);
+
+    vector<char> buffer(READ_SIZE);
+    const int rounds = 5;
+
+    double stream = BenchNanos(rounds, [&](size_t)
+    {
+        FILE *file = fopen(path.c_str(), "rb");
+        size_t total = 0, read;
+
+        while ((read = fread(buffer.data(), 1, buffer.size(), file)) > 0)
+            total += read;
+
+        fclose(file);
+        KeepValue(total);
+    });
+
+    double mapped = BenchNanos(rounds, [&](size_t)
+    {
+        utils::FileMapping mapping{};
+        mapping.open(utils::toWide(path));
+
+        size_t total = 0;
+        for (size_t offset = 0; offset < mapping.size(); offset += READ_SIZE)
+        {
+            size_t n = std::min(READ_SIZE, mapping.size() - offset);
+            memcpy(buffer.data(), mapping.data() + offset, n);
+            total += n;
+        }
+
+        KeepValue(total);
+    });
+
+    printf("file: %zu MB, reads of %zu KB\n", mb, READ_SIZE / 1024);
+    printf("stream: %8.1f MB/s\n", mb / (stream / 1e9));
+    printf("mapped: %8.1f MB/s\n", mb / (mapped / 1e9));
+
+    RemoveTree(dir);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+#include "check.h"
+
+// Pack lookups: binary search over the mapped index per request, against
+// opening the pack into a hash map first.
+//
+//   bench_pack [entries]
+
+int main(int argc, char **argv)
+{
+    size_t count = argc > 1 ? static_cast<size_t>(atoi(argv[1])) : 2000;
+
+    vector<string> names{};
+    string content(2048, 'x');
+    vector<utils::PackEntry> entries{};
+
+    for (size_t i = 0; i < count; i++)
+        names.push_back("src/components/module-" + std::to_string(i) + "/index.js");
+    for (auto &name : names)
+        entries.push_back(utils::PackEntry{ name, content.data(), content.size() });
+
+    string pack{};
+    if (!utils::writePack(entries, pack))
+        return 1;
+
+    const size_t lookups = 1000000;
+
+    double search = BenchNanos(lookups, [&](size_t i)
+    {
+        const char *data;
+        size_t length;
+        KeepValue(utils::findPackEntry(pack.data(), pack.size(), names[(i * 7919) % count], data, length));
+    });
+
+    std::unordered_map<string, const char *> map{};
+    double open = BenchNanos(10, [&](size_t)
+    {
+        vector<utils::PackEntry> read{};
+        utils::readPack(pack.data(), pack.size(), read);
+
+        map.clear();
+        for (auto &entry : read)
+            map[entry.name] = entry.data;
+    });
+
+    double hashed = BenchNanos(lookups, [&](size_t i)
+    {
+        KeepValue(map.find(names[(i * 7919) % count]));
+    });
+
+    printf("pack: %zu entries, %zu KB\n", count, pack.size() / 1024);
+    printf("binary search: %8.1f ns/lookup\n", search);
+    printf("hash map:      %8.1f ns/lookup, %.1f us to build\n", hashed, open / 1000);
+    return 0;
+}
\ No newline at end of file
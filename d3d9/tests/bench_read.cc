@@ -0,0 +1,84 @@
+#include "check.h"
+
+// Body reads of the assets resource handler (_Read), time and heap
+// allocations per call, with serve() of the same requests for contrast.
+// Built with LL_ALLOC_STATS and utils/alloc.cc, exits 1 if a read allocates.
+//
+//   bench_read [rounds]
+
+// CEF asks for this much per read.
+static const int READ_SIZE = 32 * 1024;
+
+struct Case
+{
+    const char *name;
+    bool plugin;
+    wstring path;
+    wstring referrer;
+};
+
+int main(int argc, char **argv)
+{
+    size_t rounds = argc > 1 ? static_cast<size_t>(atoi(argv[1])) : 2000;
+
+    assets::SyntheticSource source{};
+    source.add(true, L"\\my-plugin\\index.js", 2 * 1024, 1);
+    source.add(true, L"\\my-plugin\\data.json", 16 * 1024, 1);
+    source.add(false, L"\\fe\\lol-home\\video.webm", 4 * 1024 * 1024, 1);
+
+    const Case cases[] = {
+        { "small module", true, L"/my-plugin/index.js", L"" },
+        { "inline json", true, L"/my-plugin/data.json", L"https://plugins/my-plugin/index.js" },
+        { "large asset", false, L"/fe/lol-home/video.webm", L"" },
+    };
+
+    vector<char> buffer(READ_SIZE);
+    bool allocated = false;
+
+    printf("%-14s %10s %12s %12s %12s\n", "response", "bytes", "serve ns", "serve alloc", "read alloc");
+
+    for (const auto &c : cases)
+    {
+        assets::Request request{ c.path, L"", c.referrer, c.plugin, [](const char *) { return wstring{}; } };
+
+        int64 serve_allocs = utils::allocCount();
+        double serve_ns = BenchNanos(rounds, [&](size_t)
+        {
+            assets::Response response{};
+            assets::serve(source, request, response);
+            KeepValue(response.length);
+        });
+        serve_allocs = utils::allocCount() - serve_allocs;
+
+        assets::Response response{};
+        assets::serve(source, request, response);
+        if (response.status != 200)
+            return 1;
+
+        // Whole body each round, counted around the reads only.
+        int64 read_allocs = 0, calls = 0;
+        double read_ns = 0;
+
+        for (size_t r = 0; r < rounds; r++)
+        {
+            int64 offset = 0, before = utils::allocCount();
+            auto start = std::chrono::steady_clock::now();
+
+            while (assets::readBody(response, offset, buffer.data(), READ_SIZE) > 0)
+                calls++;
+
+            read_ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            read_allocs += utils::allocCount() - before;
+            KeepValue(buffer[0]);
+        }
+
+        allocated = allocated || read_allocs != 0;
+
+        printf("%-14s %10lld %12.1f %12.2f %12.2f   %.1f ns/read\n", c.name,
+            static_cast<long long>(response.length), serve_ns,
+            static_cast<double>(serve_allocs) / rounds,
+            static_cast<double>(read_allocs) / calls, read_ns / calls);
+    }
+
+    return allocated ? 1 : 0;
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#ifndef _LEAGUE_LOADER_TESTS_CHECK_H
+#define _LEAGUE_LOADER_TESTS_CHECK_H
+
+// Minimal checks and timing for tests/benchmarks, test fails if any check does.
+
+#include "src/common.h"
+#include <chrono>
+#include <string>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Failed checks of this test.
+inline int &CheckFailures()
+{
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(cond) do { if (!(cond)) { ++CheckFailures(); \
+    fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); } } while (0)
+
+#define CHECK_RESULT() (CheckFailures() == 0 ? (printf("ok\n"), 0) \
+    : (fprintf(stderr, "%d check(s) failed\n", CheckFailures()), 1))
+
+// Keep the optimizer from dropping benchmarked work.
+template <typename T>
+inline void KeepValue(const T &value)
+{
+    static const void *volatile sink;
+    sink = &value;
+    (void)sink;
+}
+
+// Average nanoseconds per call of fn.
+template <typename Fn>
+inline double BenchNanos(size_t iterations, Fn &&fn)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++)
+        fn(i);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+inline void RemoveTree(const string &path)
+{
+    if (DIR *dir = opendir(path.c_str()))
+    {
+        while (dirent *entry = readdir(dir))
+        {
+            string name = entry->d_name;
+            if (name != "." && name != "..")
+                RemoveTree(path + "/" + name);
+        }
+
+        closedir(dir);
+        rmdir(path.c_str());
+    }
+    else
+    {
+        unlink(path.c_str());
+    }
+}
+
+// Fresh scratch folder in working directory, removed by RemoveTree.
+inline string MakeTestDir(const char *name)
+{
+    string path = string(name) + "-" + std::to_string(getpid()) + ".tmp";
+    RemoveTree(path);
+    mkdir(path.c_str(), 0755);
+    return path;
+}
+
+inline bool WriteTestFile(const string &path, const string &content)
+{
+    FILE *file = fopen(path.c_str(), "wb");
+    if (file == nullptr)
+        return false;
+
+    bool ok = fwrite(content.data(), 1, content.size(), file) == content.size();
+    return fclose(file) == 0 && ok;
+}
+
+#endif
\ No newline at end of file
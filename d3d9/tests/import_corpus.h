@@ -0,0 +1,106 @@
+#ifndef _LEAGUE_LOADER_TESTS_IMPORT_CORPUS_H
+#define _LEAGUE_LOADER_TESTS_IMPORT_CORPUS_H
+
+// Plugin requests for classifyImport, and the std::regex path it replaced.
+
+#include "check.h"
+#include <regex>
+#include <unordered_set>
+
+struct ImportRequest
+{
+    wstring referrer;
+    wstring query;
+    wstring path;
+};
+
+// Former classification in assets handler Open().
+inline assets::ImportType RegexClassify(const ImportRequest &r)
+{
+    static const std::unordered_set<wstring> known_assets
+    {
+        L"bmp", L"png", L"jpg", L"jpeg", L"jfif", L"pjpeg", L"pjp", L"gif", L"svg", L"ico", L"webp",
+        L"avif", L"mp4", L"webm", L"ogg", L"mp3", L"wav", L"flac", L"aac",
+        L"woff", L"woff2", L"eot", L"ttf", L"otf",
+    };
+
+    static const std::wregex module_pattern{ L"^https:\\/\\/plugins.*\\.js(?:\\?.*)?$" };
+    static const std::wregex raw_pattern{ L"\\braw\\b" };
+    static const std::wregex url_pattern{ L"\\burl\\b" };
+
+    if (r.referrer.empty() || !std::regex_search(r.referrer, module_pattern))
+        return assets::IMPORT_DEFAULT;
+
+    if (std::regex_search(r.query, url_pattern))
+        return assets::IMPORT_URL;
+    if (std::regex_search(r.query, raw_pattern))
+        return assets::IMPORT_RAW;
+
+    size_t pos = r.path.find_last_of(L'.');
+    if (pos == wstring::npos)
+        return assets::IMPORT_DEFAULT;
+
+    auto ext = r.path.substr(pos + 1);
+    if (ext == L"css")
+        return assets::IMPORT_CSS;
+    if (ext == L"json")
+        return assets::IMPORT_JSON;
+    if (known_assets.find(ext) != known_assets.end())
+        return assets::IMPORT_URL;
+
+    return assets::IMPORT_DEFAULT;
+}
+
+inline assets::ImportType Classify(const ImportRequest &r)
+{
+    return assets::classifyImport(r.referrer.c_str(), r.referrer.length(),
+        r.query.c_str(), r.query.length(), r.path.c_str(), r.path.length());
+}
+
+// Mix seen at client startup: module graph, styles, assets and query flags,
+// from plugin and non-plugin referrers.
+inline vector<ImportRequest> BuildImportCorpus()
+{
+    static const wchar_t *referrers[] =
+    {
+        L"https://plugins/my-plugin/index.js",
+        L"https://plugins/my-plugin/index.js?v=3fa2c01b",
+        L"https://plugins/__r2/theme/index.js?v=9c1d",
+        L"https://plugins/ui-kit/components/button.js",
+        L"https://plugins/data/index.mjs",
+        L"https://plugins/",
+        L"https://riot:1234/fe/lol-champ-select/index.js",
+        L"",
+    };
+
+    static const wchar_t *queries[] =
+    {
+        L"", L"v=3fa2c01b", L"raw", L"url", L"?url", L"raw&v=1",
+        L"curl", L"raw_data", L"url=raw", L"x=1&url", L"surly", L"raws",
+    };
+
+    static const wchar_t *paths[] =
+    {
+        L"C:\\Riot Games\\League of Legends\\plugins\\my-plugin\\index.js",
+        L"C:\\Riot Games\\League of Legends\\plugins\\my-plugin\\lib\\utils.js",
+        L"C:\\Riot Games\\League of Legends\\plugins\\theme\\style.css",
+        L"C:\\Riot Games\\League of Legends\\plugins\\theme\\assets\\bg.webp",
+        L"C:\\Riot Games\\League of Legends\\plugins\\theme\\assets\\icon.PNG",
+        L"C:\\Riot Games\\League of Legends\\plugins\\data\\config.json",
+        L"C:\\Riot Games\\League of Legends\\plugins\\data\\notes.txt",
+        L"C:\\Riot Games\\League of Legends\\plugins\\fonts\\inter.woff2",
+        L"C:\\Riot Games\\League of Legends\\plugins\\sounds\\click.mp3",
+        L"C:\\Riot Games\\League of Legends\\plugins\\my-plugin\\LICENSE",
+        L"C:\\Riot Games\\League of Legends\\plugins\\my.plugin\\README",
+    };
+
+    vector<ImportRequest> corpus{};
+    for (auto referrer : referrers)
+        for (auto query : queries)
+            for (auto path : paths)
+                corpus.push_back(ImportRequest{ referrer, query, path });
+
+    return corpus;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,138 @@
+#include "check.h"
+#include <map>
+
+// Replays an assets trace through assets::serve off a synthetic tree, same as
+// the rundll32 entry (#6002) does in the client. Record a trace there with
+// RecordAssetsTrace=1, or leave it out to replay a generated startup-like one.
+//
+//   replay_bench [trace] [iterations]
+
+struct TracedRequest
+{
+    assets::Request request;
+    wstring file;
+};
+
+static assets::Request MakeRequest(bool plugin, const wstring &path, const wstring &query,
+    const wstring &referrer, std::map<string, wstring> headers = {})
+{
+    assets::Request request{ path, query, referrer, plugin, nullptr };
+    request.header = [headers](const char *name)
+    {
+        auto it = headers.find(name);
+        return it != headers.end() ? it->second : wstring{};
+    };
+    return request;
+}
+
+// Plugins with module graphs, styles, JSON and images, client assets,
+// revalidations and media ranges.
+static string GenerateTrace(size_t plugins, size_t modules)
+{
+    assets::SyntheticSource source{};
+    vector<TracedRequest> requests{};
+    int64 mtime = 132000000000000000LL;
+
+    for (size_t p = 0; p < plugins; p++)
+    {
+        auto name = L"plugin-" + std::to_wstring(p);
+        auto dir = L"\\" + name + L"\\";
+        auto referrer = L"https://plugins/" + name + L"/index.js";
+
+        source.add(true, dir + L"index.js", 4000 + p * 10, mtime);
+        requests.push_back({ MakeRequest(true, L"/" + name + L"/", L"v=" + std::to_wstring(p), L""), dir + L"index.js" });
+
+        for (size_t m = 0; m < modules; m++)
+        {
+            auto file = L"src/module-" + std::to_wstring(m) + L".js";
+            source.add(true, dir + L"src\\module-" + std::to_wstring(m) + L".js", 500 + m * 37, mtime);
+            requests.push_back({ MakeRequest(true, L"/" + name + L"/" + file, L"", referrer), dir + file });
+        }
+
+        source.add(true, dir + L"style.css", 3000, mtime);
+        source.add(true, dir + L"config.json", 400, mtime);
+        source.add(true, dir + L"assets\\icon.png", 9000, mtime);
+
+        requests.push_back({ MakeRequest(true, L"/" + name + L"/style.css", L"", referrer), dir + L"style.css" });
+        requests.push_back({ MakeRequest(true, L"/" + name + L"/config.json", L"", referrer), dir + L"config.json" });
+        requests.push_back({ MakeRequest(true, L"/" + name + L"/assets/icon.png", L"", referrer), dir + L"assets\\icon.png" });
+        requests.push_back({ MakeRequest(true, L"/" + name + L"/style.css", L"raw", referrer), dir + L"style.css" });
+        requests.push_back({ MakeRequest(true, L"/" + name + L"/missing.js", L"", referrer), L"" });
+    }
+
+    for (size_t a = 0; a < plugins * 10; a++)
+    {
+        auto path = L"\\fe\\lol-app-" + std::to_wstring(a % 7) + L"\\asset-" + std::to_wstring(a) + (a % 3 ? L".png" : L".webm");
+        source.add(false, path, 20000 + a * 100, mtime);
+
+        wstring url = path;
+        for (auto &c : url)
+            if (c == L'\\') c = L'/';
+
+        requests.push_back({ MakeRequest(false, url, L"", L"", a % 3 ? std::map<string, wstring>{}
+            : std::map<string, wstring>{ { "Range", L"bytes=0-" } }), path });
+    }
+
+    // Reload, everything revalidates.
+    size_t first = requests.size();
+    for (size_t i = 0; i < first; i++)
+    {
+        assets::Response response{};
+        assets::serve(source, requests[i].request, response);
+
+        if (response.status != 404)
+            requests.push_back({ MakeRequest(requests[i].request.plugin, requests[i].request.path,
+                requests[i].request.query, requests[i].request.referrer,
+                { { "If-None-Match", response.etag } }), requests[i].file });
+    }
+
+    string trace{};
+    for (const auto &traced : requests)
+    {
+        assets::Response response{};
+        assets::serve(source, traced.request, response);
+        trace.append(assets::formatTrace(traced.request, response, traced.file));
+    }
+
+    return trace;
+}
+
+int main(int argc, char **argv)
+{
+    string path = argc > 1 ? argv[1] : "";
+    int iterations = argc > 2 ? atoi(argv[2]) : 20;
+    string dir{};
+
+    if (path.empty())
+    {
+        dir = MakeTestDir("replay_bench");
+        path = dir + "/assets.trace";
+
+        if (!WriteTestFile(path, GenerateTrace(20, 40)))
+            return 1;
+    }
+
+    string content{};
+    vector<std::unique_ptr<assets::TraceRecord>> records{};
+
+    if (utils::readFile(utils::toWide(path), content))
+        assets::parseTrace(content, records);
+
+    if (records.empty() || iterations <= 0)
+    {
+        fprintf(stderr, "failed to read assets trace: %s\n", path.c_str());
+        return 1;
+    }
+
+    assets::SyntheticSource source{};
+    for (const auto &rec : records)
+        if (rec->status != 404) source.add(rec->request.plugin, rec->path, rec->size, rec->mtime);
+
+    auto result = assets::replay(source, records, iterations);
+    printf("trace: %s\n%s", dir.empty() ? path.c_str() : "generated", assets::formatReplay(result, "synthetic").c_str());
+
+    if (!dir.empty())
+        RemoveTree(dir);
+
+    return result.mismatches == 0 ? 0 : 1;
+}
\ No newline at end of file
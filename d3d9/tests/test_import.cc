@@ -0,0 +1,51 @@
+#include "import_corpus.h"
+
+// assets::classifyImport, same results as the regex path it replaced.
+
+static assets::ImportType Classify(const wchar_t *referrer, const wchar_t *query, const wchar_t *path)
+{
+    return Classify(ImportRequest{ referrer, query, path });
+}
+
+int main()
+{
+    const wchar_t *plugin = L"https://plugins/my-plugin/index.js";
+
+    // Only plugin module referrers.
+    CHECK(Classify(L"", L"", L"a\\style.css") == assets::IMPORT_DEFAULT);
+    CHECK(Classify(L"https://riot/index.js", L"", L"a\\style.css") == assets::IMPORT_DEFAULT);
+    CHECK(Classify(L"https://plugins/my-plugin/", L"", L"a\\style.css") == assets::IMPORT_DEFAULT);
+    CHECK(Classify(L"https://plugins/index.json", L"", L"a\\style.css") == assets::IMPORT_DEFAULT);
+    CHECK(Classify(L"https://plugins/x.js?v=1", L"", L"a\\style.css") == assets::IMPORT_CSS);
+    CHECK(Classify(L"https://plugins/x.js?a.js", L"", L"a\\style.css") == assets::IMPORT_CSS);
+
+    // Query flags as whole words, url first.
+    CHECK(Classify(plugin, L"raw", L"a\\index.js") == assets::IMPORT_RAW);
+    CHECK(Classify(plugin, L"url", L"a\\index.js") == assets::IMPORT_URL);
+    CHECK(Classify(plugin, L"raw&url", L"a\\index.js") == assets::IMPORT_URL);
+    CHECK(Classify(plugin, L"v=1&raw", L"a\\index.js") == assets::IMPORT_RAW);
+    CHECK(Classify(plugin, L"raws", L"a\\index.js") == assets::IMPORT_DEFAULT);
+    CHECK(Classify(plugin, L"curl", L"a\\index.js") == assets::IMPORT_DEFAULT);
+    CHECK(Classify(plugin, L"raw_1", L"a\\index.js") == assets::IMPORT_DEFAULT);
+
+    // Extension, case-sensitive like before.
+    CHECK(Classify(plugin, L"", L"a\\style.css") == assets::IMPORT_CSS);
+    CHECK(Classify(plugin, L"", L"a\\data.json") == assets::IMPORT_JSON);
+    CHECK(Classify(plugin, L"", L"a\\logo.png") == assets::IMPORT_URL);
+    CHECK(Classify(plugin, L"", L"a\\font.woff2") == assets::IMPORT_URL);
+    CHECK(Classify(plugin, L"", L"a\\logo.PNG") == assets::IMPORT_DEFAULT);
+    CHECK(Classify(plugin, L"", L"a\\notes.txt") == assets::IMPORT_DEFAULT);
+    CHECK(Classify(plugin, L"", L"a\\LICENSE") == assets::IMPORT_DEFAULT);
+    CHECK(Classify(plugin, L"", L"a\\file.") == assets::IMPORT_DEFAULT);
+
+    // Whole corpus against regex.
+    auto corpus = BuildImportCorpus();
+    size_t mismatches = 0;
+
+    for (auto &r : corpus)
+        if (Classify(r) != RegexClassify(r))
+            mismatches++;
+
+    CHECK(mismatches == 0);
+    return CHECK_RESULT();
+}
\ No newline at end of file
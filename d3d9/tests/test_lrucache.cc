@@ -0,0 +1,80 @@
+#include "check.h"
+#include <thread>
+
+// utils::LruByteCache shared by the assets and requireFile() caches.
+
+static std::shared_ptr<const string> Value(const char *str)
+{
+    return std::make_shared<const string>(str);
+}
+
+int main()
+{
+    utils::LruByteCache<string> cache{};
+    int64 hits, misses, evictions, bytes, entries;
+
+    // Miss, then hit by same identity.
+    CHECK(cache.find(L"a", 1, 10) == nullptr);
+    auto a = Value("a");
+    cache.insert(L"a", 1, 10, 100, a, 300);
+    CHECK(cache.find(L"a", 1, 10) == a);
+
+    // Later insert of the same key keeps the first value.
+    cache.insert(L"a", 1, 10, 100, Value("other"), 300);
+    CHECK(cache.find(L"a", 1, 10) == a);
+
+    // Edited file is stale and dropped.
+    CHECK(cache.find(L"a", 1, 11) == nullptr);
+    CHECK(cache.find(L"a", 1, 10) == nullptr);
+
+    cache.getStats(hits, misses, evictions, bytes, entries);
+    CHECK(hits == 2 && misses == 3 && evictions == 0 && bytes == 0 && entries == 0);
+
+    // Least recently used goes first over budget.
+    cache.insert(L"x", 1, 1, 100, Value("x"), 300);
+    cache.insert(L"y", 1, 1, 100, Value("y"), 300);
+    cache.insert(L"z", 1, 1, 100, Value("z"), 300);
+    CHECK(cache.find(L"x", 1, 1) != nullptr);
+    cache.insert(L"w", 1, 1, 100, Value("w"), 300);
+
+    CHECK(cache.find(L"y", 1, 1) == nullptr);
+    CHECK(cache.find(L"x", 1, 1) != nullptr);
+    CHECK(cache.find(L"z", 1, 1) != nullptr);
+    CHECK(cache.find(L"w", 1, 1) != nullptr);
+
+    cache.getStats(hits, misses, evictions, bytes, entries);
+    CHECK(evictions == 1 && bytes == 300 && entries == 3);
+
+    // Value still held by caller outlives its entry.
+    auto held = cache.find(L"w", 1, 1);
+    cache.evict([](const wstring &key) { return key == L"w" || key == L"z"; });
+    CHECK(held != nullptr && *held == "w");
+    CHECK(cache.find(L"w", 1, 1) == nullptr);
+    CHECK(cache.find(L"x", 1, 1) != nullptr);
+
+    cache.getStats(hits, misses, evictions, bytes, entries);
+    CHECK(bytes == 100 && entries == 1);
+
+    // Concurrent readers and writers over a small budget.
+    vector<std::thread> workers{};
+    for (int t = 0; t < 8; t++)
+    {
+        workers.emplace_back([&cache, t]
+        {
+            for (int i = 0; i < 2000; i++)
+            {
+                auto key = std::to_wstring((i * 7 + t) % 50);
+                if (cache.find(key, 1, 1) == nullptr)
+                    cache.insert(key, 1, 1, 10, Value("v"), 200);
+            }
+        });
+    }
+
+    for (auto &worker : workers)
+        worker.join();
+
+    cache.getStats(hits, misses, evictions, bytes, entries);
+    CHECK(bytes <= 200 && bytes == entries * 10);
+
+    return CHECK_RESULT();
+}
\ No newline at end of file
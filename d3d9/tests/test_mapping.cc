@@ -0,0 +1,85 @@
+#include "check.h"
+#include <string.h>
+
+// utils::FileMapping, mmap backend.
+
+static string ReadBack(const string &path)
+{
+    string content{};
+    char buffer[4096];
+
+    if (FILE *file = fopen(path.c_str(), "rb"))
+    {
+        size_t read;
+        while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+            content.append(buffer, read);
+        fclose(file);
+    }
+
+    return content;
+}
+
+int main()
+{
+    auto dir = MakeTestDir("test_mapping");
+
+    string content(3 * 1024 * 1024 + 17, '\0');
+    for (size_t i = 0; i < content.size(); i++)
+        content[i] = static_cast<char>(i * 2654435761u >> 13);
+
+    CHECK(WriteTestFile(dir + "/data.bin", content));
+    CHECK(WriteTestFile(dir + "/empty.bin", ""));
+    CHECK(WriteTestFile(dir + "/small.txt", "hello"));
+
+    utils::FileMapping mapping{};
+
+    // Missing file and folder.
+    CHECK(!mapping.open(utils::toWide(dir + "/missing.bin")));
+    CHECK(mapping.data() == nullptr && mapping.size() == 0);
+    CHECK(!mapping.open(utils::toWide(dir)));
+
+    // Whole content.
+    CHECK(mapping.open(utils::toWide(dir + "/data.bin")));
+    CHECK(mapping.size() == content.size());
+    CHECK(mapping.data() != nullptr && memcmp(mapping.data(), content.data(), content.size()) == 0);
+
+    // Reopen drops previous view.
+    CHECK(mapping.open(utils::toWide(dir + "/small.txt")));
+    CHECK(string(mapping.data(), mapping.size()) == "hello");
+
+    // Empty file has a valid empty view.
+    CHECK(mapping.open(utils::toWide(dir + "/empty.bin")));
+    CHECK(mapping.data() != nullptr && mapping.size() == 0);
+
+    // Windows separators.
+    CHECK(mapping.open(utils::toWide(dir + "\\small.txt")));
+    CHECK(mapping.size() == 5);
+
+    mapping.close();
+    CHECK(mapping.data() == nullptr && mapping.size() == 0);
+
+    // Copy-on-write, writes never reach the file.
+    {
+        utils::FileMapping cow{};
+        CHECK(cow.open(utils::toWide(dir + "/data.bin"), true));
+        CHECK(cow.size() == content.size());
+
+        auto view = const_cast<char *>(cow.data());
+        memset(view, 'x', 4096);
+        view[cow.size() - 1] = 'y';
+        CHECK(view[0] == 'x' && view[cow.size() - 1] == 'y');
+    }
+
+    CHECK(ReadBack(dir + "/data.bin") == content);
+
+    // Read-only views of one file share its content.
+    {
+        utils::FileMapping a{}, b{};
+        CHECK(a.open(utils::toWide(dir + "/data.bin")));
+        CHECK(b.open(utils::toWide(dir + "/data.bin")));
+        CHECK(a.size() == b.size() && memcmp(a.data(), b.data(), a.size()) == 0);
+    }
+
+    RemoveTree(dir);
+    return CHECK_RESULT();
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+#include "check.h"
+#include <string.h>
+#include <unordered_map>
+
+// utils::getMimeType, every table entry in every letter case, and every
+// short extension outside of it.
+
+static const std::unordered_map<string, string> expected
+{
+    { "bmp", "image/bmp" }, { "png", "image/png" },
+    { "jpg", "image/jpeg" }, { "jpeg", "image/jpeg" }, { "jfif", "image/jpeg" },
+    { "pjpeg", "image/jpeg" }, { "pjp", "image/jpeg" }, { "gif", "image/gif" },
+    { "svg", "image/svg+xml" }, { "ico", "image/x-icon" }, { "webp", "image/webp" },
+    { "avif", "image/avif" },
+
+    { "mp4", "video/mp4" }, { "webm", "video/webm" },
+    { "ogg", "audio/ogg" }, { "mp3", "audio/mpeg" }, { "wav", "audio/wav" },
+    { "flac", "audio/flac" }, { "aac", "audio/aac" },
+
+    { "woff", "font/woff" }, { "woff2", "font/woff2" },
+    { "eot", "application/vnd.ms-fontobject" }, { "ttf", "font/ttf" }, { "otf", "font/otf" },
+
+    { "css", "text/css" }, { "js", "text/javascript" }, { "json", "application/json" },
+    { "html", "text/html" }, { "wasm", "application/wasm" },
+};
+
+static const char *Lookup(const wstring &ext)
+{
+    return utils::getMimeType(ext.c_str(), ext.length());
+}
+
+int main()
+{
+    // Known, all case combinations.
+    for (const auto &entry : expected)
+    {
+        auto ext = utils::toWide(entry.first);
+        size_t n = ext.length();
+
+        for (size_t mask = 0; mask < (size_t(1) << n); mask++)
+        {
+            wstring cased = ext;
+            for (size_t i = 0; i < n; i++)
+                if (mask & (size_t(1) << i) && cased[i] >= L'a' && cased[i] <= L'z')
+                    cased[i] -= L'a' - L'A';
+
+            const char *mime = Lookup(cased);
+            CHECK(mime != nullptr && entry.second == mime);
+        }
+
+        // Prefix and longer names are different extensions.
+        CHECK(Lookup(ext.substr(0, n - 1)) == nullptr || expected.count(entry.first.substr(0, n - 1)));
+        CHECK(Lookup(ext + L"x") == nullptr || expected.count(entry.first + "x"));
+    }
+
+    // Unknown, every extension of up to 3 characters.
+    static const char chars[] = "abcdefghijklmnopqrstuvwxyz0123456789";
+    const size_t k = sizeof(chars) - 1;
+    size_t wrong = 0;
+
+    for (size_t n = 1; n <= 3; n++)
+    {
+        size_t total = 1;
+        for (size_t i = 0; i < n; i++) total *= k;
+
+        for (size_t v = 0; v < total; v++)
+        {
+            string ext{};
+            for (size_t i = 0, x = v; i < n; i++, x /= k)
+                ext.push_back(chars[x % k]);
+
+            const char *mime = Lookup(utils::toWide(ext));
+            auto it = expected.find(ext);
+
+            if (it == expected.end() ? mime != nullptr : (mime == nullptr || it->second != mime))
+                wrong++;
+        }
+    }
+
+    CHECK(wrong == 0);
+
+    // Edge input.
+    CHECK(utils::getMimeType(L"", 0) == nullptr);
+    CHECK(Lookup(L"woff2woff2") == nullptr);
+    CHECK(Lookup(L"pñg") == nullptr);
+    CHECK(Lookup(L"PNGİ") == nullptr);
+    CHECK(Lookup(L".png") == nullptr);
+    CHECK(utils::getMimeType(L"pngxyz", 3) != nullptr);
+
+    return CHECK_RESULT();
+}
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include "check.h"
+#include <string.h>
+
+// Plugin pack format: round trip, lookup and corrupt input.
+
+static string MakeContent(size_t i)
+{
+    string content(i % 97, '\0');
+    for (size_t k = 0; k < content.size(); k++)
+        content[k] = static_cast<char>(i * 31 + k);
+    return content;
+}
+
+static void PatchU32(string &pack, size_t offset, uint32_t value)
+{
+    memcpy(&pack[offset], &value, sizeof(value));
+}
+
+int main()
+{
+    // Unsorted names with binary and empty contents.
+    vector<string> names{}, contents{};
+    for (size_t i = 0; i < 500; i++)
+    {
+        names.push_back("dir" + std::to_string(i % 7) + "/file-" + std::to_string((i * 7919) % 500) + ".js");
+        contents.push_back(MakeContent(i));
+    }
+    names.push_back("index.js");
+    contents.push_back("export default 1;");
+
+    vector<utils::PackEntry> entries{};
+    for (size_t i = 0; i < names.size(); i++)
+        entries.push_back(utils::PackEntry{ names[i], contents[i].data(), contents[i].size() });
+
+    string pack{};
+    CHECK(utils::writePack(entries, pack));
+
+    // Read back sorted, all contents intact.
+    vector<utils::PackEntry> read{};
+    CHECK(utils::readPack(pack.data(), pack.size(), read));
+    CHECK(read.size() == entries.size());
+
+    for (size_t i = 1; i < read.size(); i++)
+        CHECK(read[i - 1].name < read[i].name);
+
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        const char *data = nullptr;
+        size_t length = 0;
+
+        CHECK(utils::findPackEntry(pack.data(), pack.size(), names[i], data, length));
+        CHECK(length == contents[i].size() && memcmp(data, contents[i].data(), length) == 0);
+    }
+
+    // Misses.
+    const char *data = nullptr;
+    size_t length = 0;
+    CHECK(!utils::findPackEntry(pack.data(), pack.size(), "missing.js", data, length));
+    CHECK(!utils::findPackEntry(pack.data(), pack.size(), "index.j", data, length));
+    CHECK(!utils::findPackEntry(pack.data(), pack.size(), "", data, length));
+
+    // Empty pack.
+    string empty{};
+    CHECK(utils::writePack({}, empty));
+    CHECK(utils::readPack(empty.data(), empty.size(), read) && read.empty());
+    CHECK(!utils::findPackEntry(empty.data(), empty.size(), "index.js", data, length));
+
+    // Served from a mapped file like the handler does.
+    auto dir = MakeTestDir("test_pack");
+    CHECK(WriteTestFile(dir + "/plugin.llpk", pack));
+    {
+        utils::FileMapping mapping{};
+        CHECK(mapping.open(utils::toWide(dir + "/plugin.llpk")));
+        CHECK(utils::findPackEntry(mapping.data(), mapping.size(), "index.js", data, length));
+        CHECK(string(data, length) == "export default 1;");
+    }
+    RemoveTree(dir);
+
+    // Corrupt input never reads out of bounds.
+    CHECK(!utils::readPack(pack.data(), 0, read));
+    CHECK(!utils::readPack(pack.data(), 15, read));
+
+    string bad = pack;
+    bad[0] = 'X';
+    CHECK(!utils::readPack(bad.data(), bad.size(), read));
+    CHECK(!utils::findPackEntry(bad.data(), bad.size(), "index.js", data, length));
+
+    bad = pack;
+    PatchU32(bad, 4, 2);    // version
+    CHECK(!utils::readPack(bad.data(), bad.size(), read));
+
+    bad = pack;
+    PatchU32(bad, 8, 0x10000000);   // count beyond file
+    CHECK(!utils::readPack(bad.data(), bad.size(), read));
+
+    bad = pack;
+    PatchU32(bad, 16 + 12, 0xFFFFFFF0);     // first data size
+    CHECK(!utils::readPack(bad.data(), bad.size(), read));
+
+    bad = pack;
+    PatchU32(bad, 16, 0xFFFFFFF0);  // first name offset
+    CHECK(!utils::readPack(bad.data(), bad.size(), read));
+
+    // Truncated data.
+    CHECK(!utils::readPack(pack.data(), pack.size() - 1, read));
+
+    return CHECK_RESULT();
+}
\ No newline at end of file
@@ -0,0 +1,141 @@
+#include "check.h"
+
+// PluginsIndex resolution over a synthetic plugins tree, nothing on disk.
+
+static bool Resolve(PluginsIndex &index, const wchar_t *request, const wchar_t *expected, bool expected_js)
+{
+    wstring resolved{};
+    bool js = !expected_js;
+
+    if (!index.Resolve(request, resolved, js))
+        return expected == nullptr;
+
+    return expected != nullptr && resolved == expected && js == expected_js;
+}
+
+int main()
+{
+    PluginsIndex index{};
+
+    index.Add(L"my-plugin", true);
+    index.Add(L"my-plugin\\index.js", false);
+    index.Add(L"my-plugin\\utils.js", false);
+    index.Add(L"my-plugin\\lib", true);
+    index.Add(L"my-plugin\\lib\\index.js", false);
+    index.Add(L"my-plugin\\assets", true);
+    index.Add(L"my-plugin\\assets\\Logo.PNG", false);
+    index.Add(L"my-plugin\\assets\\style.css", false);
+    index.Add(L"my-plugin\\LICENSE", false);
+    index.Add(L"my-plugin\\worker.mjs", false);
+    index.Add(L"Other", true);
+    index.Add(L"Other\\Index.js", false);
+    index.Add(L"both", true);
+    index.Add(L"both.js", false);
+    index.Add(L"both\\index.js", false);
+
+    // Entry by trailing slash, folder or explicit file.
+    CHECK(Resolve(index, L"/my-plugin/", L"my-plugin\\index.js", true));
+    CHECK(Resolve(index, L"/my-plugin", L"my-plugin\\index.js", true));
+    CHECK(Resolve(index, L"/my-plugin/index.js", L"my-plugin\\index.js", true));
+
+    // Extensionless import, .js then folder index.js.
+    CHECK(Resolve(index, L"/my-plugin/utils", L"my-plugin\\utils.js", true));
+    CHECK(Resolve(index, L"/my-plugin/lib", L"my-plugin\\lib\\index.js", true));
+    CHECK(Resolve(index, L"/both", L"both.js", true));
+
+    // Other files keep their type to MIME lookup.
+    CHECK(Resolve(index, L"/my-plugin/assets/style.css", L"my-plugin\\assets\\style.css", false));
+    CHECK(Resolve(index, L"/my-plugin/worker.mjs", L"my-plugin\\worker.mjs", true));
+    CHECK(Resolve(index, L"/my-plugin/LICENSE", L"my-plugin\\LICENSE", false));
+
+    // Case-insensitive like the file system, resolved path keeps original case.
+    CHECK(Resolve(index, L"/MY-PLUGIN/ASSETS/logo.png", L"my-plugin\\assets\\Logo.PNG", false));
+    CHECK(Resolve(index, L"/other/", L"Other\\Index.js", true));
+
+    // Dot segments and Windows separators.
+    CHECK(Resolve(index, L"/my-plugin/lib/../utils.js", L"my-plugin\\utils.js", true));
+    CHECK(Resolve(index, L"\\my-plugin\\.\\utils", L"my-plugin\\utils.js", true));
+
+    // Not found, folders are never resolved as files.
+    CHECK(Resolve(index, L"/my-plugin/missing.js", nullptr, false));
+    CHECK(Resolve(index, L"/my-plugin/assets/", nullptr, false));
+    CHECK(Resolve(index, L"/my-plugin/assets", nullptr, false));
+    CHECK(Resolve(index, L"/missing/", nullptr, false));
+
+    CHECK(index.IsDir(L"my-plugin\\lib"));
+    CHECK(!index.IsDir(L"my-plugin\\utils.js"));
+
+    // Removed folder takes its children.
+    index.Remove(L"my-plugin\\lib");
+    CHECK(Resolve(index, L"/my-plugin/lib", nullptr, false));
+    CHECK(Resolve(index, L"/my-plugin/lib/index.js", nullptr, false));
+    CHECK(Resolve(index, L"/my-plugin/utils", L"my-plugin\\utils.js", true));
+
+    // Packed files point into pack content.
+    auto pack = std::make_shared<PluginPack>();
+    static const char content[] = "export default 1;";
+
+    index.Add(L"packed", true);
+    index.AddPacked(L"packed\\index.js", pack, content, sizeof(content) - 1);
+
+    std::shared_ptr<PluginPack> found;
+    const char *data = nullptr;
+    size_t size = 0;
+
+    CHECK(Resolve(index, L"/packed/", L"packed\\index.js", true));
+    CHECK(index.GetPacked(L"packed\\INDEX.js", found, data, size));
+    CHECK(found == pack && data == content && size == sizeof(content) - 1);
+    CHECK(!index.GetPacked(L"my-plugin\\index.js", found, data, size));
+
+    // Folder module is cached until a change below it.
+    wstring module{};
+    uint64_t epoch = 0;
+
+    index.Add(L"_shared", true);
+    index.Add(L"_shared\\lib", true);
+    index.Add(L"_shared\\lib\\dist", true);
+    CHECK(!index.GetModule(L"_shared\\lib", module, epoch));
+    index.SetModule(L"_shared\\lib", L"dist/lib.js", epoch);
+    CHECK(index.GetModule(L"_shared/LIB", module, epoch) && module == L"dist/lib.js");
+
+    index.ClearModules(L"_shared\\lib\\dist\\lib.js");
+    CHECK(!index.GetModule(L"_shared\\lib", module, epoch));
+
+    // Lookup raced by a change is not kept.
+    uint64_t stale = epoch;
+    index.ClearModules(L"_shared\\lib\\package.json");
+    index.SetModule(L"_shared\\lib", L"old.js", stale);
+    CHECK(!index.GetModule(L"_shared\\lib", module, epoch));
+
+    index.SetModule(L"_shared\\lib", L"", epoch);
+    CHECK(index.GetModule(L"_shared\\lib", module, epoch) && module.empty());
+    index.SetModule(L"_shared\\missing", L"x.js", epoch);
+    CHECK(!index.GetModule(L"_shared\\missing", module, epoch));
+
+    // Swap replaces content at once.
+    PluginsIndex other{};
+    other.Add(L"fresh", true);
+    other.Add(L"fresh\\index.js", false);
+    index.Swap(other);
+
+    CHECK(Resolve(index, L"/fresh/", L"fresh\\index.js", true));
+    CHECK(Resolve(index, L"/my-plugin/", nullptr, false));
+    CHECK(Resolve(other, L"/my-plugin/", L"my-plugin\\index.js", true));
+
+    // Same rules over any lookup.
+    wstring resolved{};
+    bool js = false;
+    bool found_custom = PluginsIndex::ResolveWith(L"/a/b", resolved, js, [](const wstring &key, bool &dir, wstring &path)
+    {
+        dir = key == L"a/b";
+        if (key == L"a/b/index.js") path = L"A\\B\\index.js";
+        return dir || key == L"a/b/index.js";
+    });
+
+    CHECK(found_custom && resolved == L"A\\B\\index.js" && js);
+
+    CHECK(PluginsIndex::Normalize(L"/a//b/./c/../d/") == L"a\\b\\d");
+    CHECK(PluginsIndex::Normalize(L"../../a") == L"a");
+
+    return CHECK_RESULT();
+}
\ No newline at end of file
@@ -0,0 +1,282 @@
+#include "check.h"
+#include <thread>
+
+// plugins::scan over thousands of synthetic plugin folders, packs and shared libraries.
+//
+//   test_scan [plugins]
+
+// package.json in tests is one flat object of string values.
+static string JsonValue(const char *data, size_t length, const string &key)
+{
+    string json(data, length);
+    size_t pos = json.find("\"" + key + "\"");
+    if (pos == string::npos)
+        return "";
+
+    size_t start = json.find('"', json.find(':', pos) + 1) + 1;
+    return json.substr(start, json.find('"', start) - start);
+}
+
+class TestHost : public plugins::Host
+{
+public:
+    std::atomic<int> metas{ 0 };
+    std::atomic<int> entries{ 0 };
+
+    void parseMeta(const char *data, size_t length, plugins::ManifestEntry &entry) override
+    {
+        static const char *names[] = { "critical", "normal", "idle" };
+        auto priority = JsonValue(data, length, "priority");
+
+        for (int i = 0; i < 3; i++)
+            if (priority == names[i]) entry.priority = i;
+
+        entry.route = utils::toWide(JsonValue(data, length, "route"));
+        metas++;
+    }
+
+    wstring getPackageEntry(const wstring &folder) override
+    {
+        string content{};
+        vector<wstring> candidates{};
+
+        if (utils::readFile(folder + L"\\package.json", content))
+        {
+            auto main = JsonValue(content.data(), content.length(), "main");
+            if (!main.empty()) candidates.push_back(utils::toWide(main));
+        }
+
+        entries++;
+        return utils::findPackageEntry(folder, candidates);
+    }
+
+    bool post(std::function<void()> task) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        threads_.emplace_back(std::move(task));
+        return true;
+    }
+
+    void join()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto &thread : threads_)
+            thread.join();
+        threads_.clear();
+    }
+
+private:
+    std::mutex mutex_;
+    vector<std::thread> threads_;
+};
+
+struct ScanResult
+{
+    plugins::Manifest manifest;
+    bool changed;
+    double millis;
+};
+
+static ScanResult Scan(TestHost &host, const string &dir, const plugins::Manifest &known, bool wait)
+{
+    ScanResult result{};
+    int calls = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    plugins::scan(host, utils::toWide(dir), known, [&](plugins::Manifest &manifest, bool changed)
+    {
+        result.manifest = std::move(manifest);
+        result.changed = changed;
+        calls++;
+    }, wait);
+    host.join();
+
+    result.millis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    CHECK(calls == 1);
+    return result;
+}
+
+static string PluginName(size_t i)
+{
+    return "plugin-" + std::to_string(10000 + i);
+}
+
+static string PluginCode(size_t i, size_t version = 0)
+{
+    return "export default " + std::to_string(i * 7 + version) + ";" + string(i % 13 + version, ' ');
+}
+
+static bool SameManifest(const plugins::Manifest &a, const plugins::Manifest &b)
+{
+    return plugins::formatManifest(a) == plugins::formatManifest(b);
+}
+
+int main(int argc, char **argv)
+{
+    size_t count = argc > 1 ? static_cast<size_t>(atoi(argv[1])) : 3000;
+    auto dir = MakeTestDir("test_scan");
+    auto wdir = utils::toWide(dir);
+
+    // Folders, every 10th without index.js, every 3rd with package.json.
+    for (size_t i = 0; i < count; i++)
+    {
+        auto folder = dir + "/" + PluginName(i);
+        mkdir(folder.c_str(), 0755);
+
+        if (i % 10 != 9)
+            WriteTestFile(folder + "/index.js", PluginCode(i));
+        if (i % 3 == 0)
+            WriteTestFile(folder + "/package.json", "{ \"loader\": { \"priority\": \"idle\", \"route\": \"/r" + std::to_string(i) + "\" } }");
+    }
+
+    // Packs, one shadowed by folder of same name.
+    const string packed_code = "export default 'packed';";
+    const string packed_meta = "{ \"loader\": { \"priority\": \"critical\" } }";
+    vector<utils::PackEntry> entries{
+        { "index.js", packed_code.data(), packed_code.size() },
+        { "package.json", packed_meta.data(), packed_meta.size() },
+    };
+
+    string pack{};
+    CHECK(utils::writePack(entries, pack));
+    CHECK(WriteTestFile(dir + "/packed.llpk", pack));
+    CHECK(WriteTestFile(dir + "/" + PluginName(0) + ".llpk", pack));
+
+    // Skipped names.
+    mkdir((dir + "/.hidden").c_str(), 0755);
+    WriteTestFile(dir + "/.hidden/index.js", "x");
+    mkdir((dir + "/_disabled").c_str(), 0755);
+    WriteTestFile(dir + "/_disabled/index.js", "x");
+
+    // Shared libraries, with subpath package and scoped one.
+    mkdir((dir + "/_shared").c_str(), 0755);
+    mkdir((dir + "/_shared/preact").c_str(), 0755);
+    mkdir((dir + "/_shared/preact/dist").c_str(), 0755);
+    WriteTestFile(dir + "/_shared/preact/package.json", "{ \"main\": \"./dist/preact\" }");
+    WriteTestFile(dir + "/_shared/preact/dist/preact.js", "export const h = 1;");
+    mkdir((dir + "/_shared/preact/hooks").c_str(), 0755);
+    WriteTestFile(dir + "/_shared/preact/hooks/package.json", "{ \"main\": \"hooks.js\" }");
+    WriteTestFile(dir + "/_shared/preact/hooks/hooks.js", "export const useState = 1;");
+    mkdir((dir + "/_shared/preact/node_modules").c_str(), 0755);
+    mkdir((dir + "/_shared/preact/node_modules/x").c_str(), 0755);
+    WriteTestFile(dir + "/_shared/preact/node_modules/x/package.json", "{}");
+    mkdir((dir + "/_shared/@scope").c_str(), 0755);
+    mkdir((dir + "/_shared/@scope/lib").c_str(), 0755);
+    WriteTestFile(dir + "/_shared/@scope/lib/index.js", "export default 1;");
+
+    TestHost host{};
+
+    // First launch, inline.
+    auto cold = Scan(host, dir, plugins::Manifest{}, true);
+    auto &manifest = cold.manifest;
+
+    CHECK(cold.changed);
+    CHECK(manifest.entries.size() == count + 2 + 3);
+    CHECK(manifest.dir_mtime != 0);
+
+    for (size_t i = 1; i < manifest.entries.size(); i++)
+        CHECK(manifest.entries[i - 1].name < manifest.entries[i].name);
+
+    size_t wrong = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        auto entry = plugins::findEntry(manifest, utils::toWide(PluginName(i)));
+        auto code = PluginCode(i);
+
+        if (entry == nullptr
+            || entry->valid != (i % 10 != 9)
+            || (entry->valid && entry->hash != utils::hashContent(code.data(), code.size()))
+            || entry->priority != (i % 3 == 0 ? plugins::PRIORITY_IDLE : plugins::PRIORITY_NORMAL)
+            || entry->route != (i % 3 == 0 ? utils::toWide("/r" + std::to_string(i)) : L""))
+            wrong++;
+    }
+    CHECK(wrong == 0);
+
+    auto packed = plugins::findEntry(manifest, L"packed.llpk");
+    CHECK(packed != nullptr && packed->valid && packed->priority == plugins::PRIORITY_CRITICAL);
+    CHECK(packed->hash == utils::hashContent(packed_code.data(), packed_code.size()));
+    CHECK(plugins::getPluginName(packed->name) == L"packed");
+
+    auto shadowed = plugins::findEntry(manifest, utils::toWide(PluginName(0) + ".llpk"));
+    CHECK(shadowed != nullptr && !shadowed->valid);
+
+    CHECK(plugins::findEntry(manifest, L".hidden") == nullptr);
+    CHECK(plugins::findEntry(manifest, L"_disabled") == nullptr);
+
+    auto preact = plugins::findEntry(manifest, L"_shared/preact");
+    auto hooks = plugins::findEntry(manifest, L"_shared/preact/hooks");
+    auto scoped = plugins::findEntry(manifest, L"_shared/@scope/lib");
+    CHECK(preact != nullptr && preact->valid && preact->module == L"dist/preact.js");
+    CHECK(hooks != nullptr && hooks->valid && hooks->module == L"hooks.js");
+    CHECK(scoped != nullptr && scoped->valid && scoped->module == L"index.js");
+    CHECK(plugins::getPluginName(hooks->name) == L"preact/hooks");
+    CHECK(plugins::findEntry(manifest, L"_shared/preact/node_modules") == nullptr);
+
+    // Manifest file round trip.
+    plugins::Manifest parsed{};
+    CHECK(plugins::parseManifest(plugins::formatManifest(manifest), parsed));
+    CHECK(SameManifest(parsed, manifest));
+    CHECK(parsed.entries.size() == manifest.entries.size());
+    CHECK(!plugins::parseManifest("LLPM 2 0\n", parsed));
+    CHECK(!plugins::parseManifest("", parsed));
+
+    // Relaunch on workers, nothing is reparsed or rehashed.
+    host.metas = 0;
+    host.entries = 0;
+    auto warm = Scan(host, dir, parsed, false);
+
+    CHECK(!warm.changed);
+    CHECK(SameManifest(warm.manifest, manifest));
+    CHECK(host.metas == 0 && host.entries == 0);
+
+    for (const auto &entry : manifest.entries)
+        if (entry.valid && !plugins::isSharedName(entry.name))
+            CHECK(plugins::isEntryFresh(wdir, entry));
+
+    // Edited plugin, only its hash changes.
+    auto edited = PluginCode(5, 1);
+    CHECK(WriteTestFile(dir + "/" + PluginName(5) + "/index.js", edited));
+    CHECK(!plugins::isEntryFresh(wdir, *plugins::findEntry(manifest, utils::toWide(PluginName(5)))));
+
+    // Rehashed inline on launch, as is done for changed entries.
+    {
+        auto last = *plugins::findEntry(manifest, utils::toWide(PluginName(5)));
+        plugins::ManifestEntry entry{};
+
+        plugins::scanEntry(host, wdir, last.name, &last, entry);
+        CHECK(entry.valid && entry.hash == utils::hashContent(edited.data(), edited.size()));
+        CHECK(plugins::isEntryFresh(wdir, entry));
+    }
+
+    auto rescan = Scan(host, dir, manifest, false);
+    CHECK(rescan.changed);
+    CHECK(plugins::findEntry(rescan.manifest, utils::toWide(PluginName(5)))->hash
+        == utils::hashContent(edited.data(), edited.size()));
+
+    size_t changed = 0;
+    for (size_t i = 0; i < manifest.entries.size(); i++)
+        if (manifest.entries[i].hash != rescan.manifest.entries[i].hash) changed++;
+    CHECK(changed == 1);
+
+    // Folder that got its index.js, added and removed plugins.
+    CHECK(WriteTestFile(dir + "/" + PluginName(9) + "/index.js", PluginCode(9)));
+    mkdir((dir + "/added").c_str(), 0755);
+    CHECK(WriteTestFile(dir + "/added/index.js", "export default 'added';"));
+    unlink((dir + "/" + PluginName(1) + "/index.js").c_str());
+    rmdir((dir + "/" + PluginName(1)).c_str());
+
+    auto updated = Scan(host, dir, rescan.manifest, false);
+    auto fixed = plugins::findEntry(updated.manifest, utils::toWide(PluginName(9)));
+    auto added = plugins::findEntry(updated.manifest, L"added");
+
+    CHECK(updated.changed);
+    CHECK(fixed != nullptr && fixed->valid);
+    CHECK(added != nullptr && added->valid);
+    CHECK(plugins::findEntry(updated.manifest, utils::toWide(PluginName(1))) == nullptr);
+    CHECK(updated.manifest.entries.size() == manifest.entries.size());
+
+    printf("%zu plugins: cold scan %.1f ms, revalidation %.1f ms\n", count, cold.millis, warm.millis);
+
+    RemoveTree(dir);
+    return CHECK_RESULT();
+}
\ No newline at end of file
@@ -0,0 +1,183 @@
+#include "check.h"
+#include <string.h>
+#include <algorithm>
+#include <map>
+
+// assets::serve over a synthetic tree: validators, ranges, inline modules,
+// fingerprints and the trace format replay_bench reads.
+
+// FILETIME ticks of Unix time.
+static int64 FileTime(int64 unix_seconds)
+{
+    return (unix_seconds + 11644473600LL) * 10000000;
+}
+
+static assets::Request MakeRequest(bool plugin, const wstring &path, const wstring &query = L"",
+    const wstring &referrer = L"", std::map<string, wstring> headers = {})
+{
+    assets::Request request{ path, query, referrer, plugin, nullptr };
+    request.header = [headers](const char *name)
+    {
+        auto it = headers.find(name);
+        return it != headers.end() ? it->second : wstring{};
+    };
+    return request;
+}
+
+static assets::Response Serve(assets::Source &source, const assets::Request &request)
+{
+    assets::Response response{};
+    assets::serve(source, request, response);
+    return response;
+}
+
+static string Body(const assets::Response &response)
+{
+    return response.data != nullptr ? string(response.data, static_cast<size_t>(response.length)) : "";
+}
+
+int main()
+{
+    // HTTP dates, example of RFC 7231.
+    int64 mtime = FileTime(784111777) + 1234567;
+    int64 parsed = 0;
+
+    CHECK(assets::formatHttpDate(mtime) == L"Sun, 06 Nov 1994 08:49:37 GMT");
+    CHECK(assets::parseHttpDate(L"Sun, 06 Nov 1994 08:49:37 GMT", parsed) && parsed == FileTime(784111777));
+    CHECK(assets::formatHttpDate(FileTime(951782400)) == L"Tue, 29 Feb 2000 00:00:00 GMT");
+    CHECK(assets::formatHttpDate(FileTime(-86400)) == L"Wed, 31 Dec 1969 00:00:00 GMT");
+    CHECK(assets::formatHttpDate(0) == L"Mon, 01 Jan 1601 00:00:00 GMT");
+    CHECK(assets::parseHttpDate(L"Tue, 29 Feb 2000 00:00:00 GMT", parsed) && parsed == FileTime(951782400));
+    CHECK(!assets::parseHttpDate(L"Sat, 29 Feb 2003 00:00:00 GMT", parsed));
+    CHECK(!assets::parseHttpDate(L"Sun, 06 Foo 1994 08:49:37 GMT", parsed));
+    CHECK(!assets::parseHttpDate(L"Sun, 06 Nov 1994 24:00:00 GMT", parsed));
+    CHECK(!assets::parseHttpDate(L"yesterday", parsed));
+
+    bool dates_ok = true;
+    for (int64 t = 0; t < 4000000000LL && dates_ok; t += 7777777)
+    {
+        int64 back;
+        dates_ok = assets::parseHttpDate(assets::formatHttpDate(FileTime(t)), back) && back == FileTime(t);
+    }
+    CHECK(dates_ok);
+
+    assets::SyntheticSource source{};
+    source.add(true, L"\\my-plugin\\index.js", 1000, mtime);
+    source.add(true, L"\\my-plugin\\theme.css", 200, mtime);
+    source.add(true, L"\\my-plugin\\data.json", 10, mtime);
+    source.add(true, L"\\my-plugin\\Logo.png", 300, mtime);
+    source.add(false, L"\\fe\\lol-home\\index.html", 500, mtime);
+
+    // Plugin entry by folder.
+    auto entry = Serve(source, MakeRequest(true, L"/my-plugin/"));
+    CHECK(entry.status == 200 && entry.import == assets::IMPORT_DEFAULT);
+    CHECK(entry.mime != nullptr && strcmp(entry.mime, "text/javascript") == 0);
+    CHECK(entry.length == 1000 && entry.data != nullptr && entry.cache_hit);
+    CHECK(entry.last_modified == L"Sun, 06 Nov 1994 08:49:37 GMT");
+    CHECK(entry.etag.size() > 2 && entry.etag.front() == L'"' && entry.etag.back() == L'"');
+    CHECK(!entry.immutable && !entry.preload);
+
+    // Body is read in chunks off the memory view.
+    char chunk[600];
+    int64 offset = 0;
+    CHECK(assets::readBody(entry, offset, chunk, sizeof(chunk)) == 600 && offset == 600);
+    CHECK(assets::readBody(entry, offset, chunk, sizeof(chunk)) == 400 && offset == 1000);
+    CHECK(assets::readBody(entry, offset, chunk, sizeof(chunk)) == 0 && offset == 1000);
+    CHECK(chunk[39] == '\n' && chunk[0] == 'a');
+
+    CHECK(Serve(source, MakeRequest(true, L"/my-plugin/missing.js")).status == 404);
+    CHECK(Serve(source, MakeRequest(false, L"/missing.html")).status == 404);
+
+    auto html = Serve(source, MakeRequest(false, L"/fe/lol-home/index.html"));
+    CHECK(html.status == 200 && html.mime != nullptr && strcmp(html.mime, "text/html") == 0);
+
+    // Validators, ETag wins over date.
+    CHECK(Serve(source, MakeRequest(true, L"/my-plugin/", L"", L"", { { "If-None-Match", entry.etag } })).status == 304);
+    CHECK(Serve(source, MakeRequest(true, L"/my-plugin/", L"", L"", { { "If-None-Match", L"\"x\", W/" + entry.etag } })).status == 304);
+    CHECK(Serve(source, MakeRequest(true, L"/my-plugin/", L"", L"", { { "If-None-Match", L"*" } })).status == 304);
+    CHECK(Serve(source, MakeRequest(true, L"/my-plugin/", L"", L"",
+        { { "If-None-Match", L"\"other\"" }, { "If-Modified-Since", entry.last_modified } })).status == 200);
+    CHECK(Serve(source, MakeRequest(true, L"/my-plugin/", L"", L"", { { "If-Modified-Since", entry.last_modified } })).status == 304);
+    CHECK(Serve(source, MakeRequest(true, L"/my-plugin/", L"", L"",
+        { { "If-Modified-Since", L"Sat, 05 Nov 1994 08:49:37 GMT" } })).status == 200);
+
+    // Ranges.
+    auto range = [&](const wchar_t *header)
+    {
+        return Serve(source, MakeRequest(true, L"/my-plugin/index.js", L"", L"", { { "Range", header } }));
+    };
+
+    auto head = range(L"bytes=0-9");
+    CHECK(head.status == 206 && head.range == L"bytes 0-9/1000");
+    CHECK(range(L"bytes=-5").range == L"bytes 995-999/1000");
+    CHECK(range(L"bytes=990-").range == L"bytes 990-999/1000");
+    CHECK(range(L"bytes=990-5000").range == L"bytes 990-999/1000");
+    CHECK(range(L"bytes=1000-").status == 416 && range(L"bytes=1000-").range == L"bytes */1000");
+    CHECK(range(L"bytes=0-1,5-6").status == 200);
+    CHECK(range(L"bytes=9-1").status == 200);
+    CHECK(range(L"items=0-1").status == 200);
+
+    // Imports from a plugin module.
+    const wstring referrer = L"https://plugins/my-plugin/index.js";
+
+    auto json = Serve(source, MakeRequest(true, L"/my-plugin/data.json", L"", referrer));
+    CHECK(json.status == 200 && json.import == assets::IMPORT_JSON);
+    CHECK(Body(json) == "export default JSON.parse(\"aaaaaaaaaa\");\n");
+
+    auto raw = Serve(source, MakeRequest(true, L"/my-plugin/theme.css", L"raw", referrer));
+    CHECK(raw.import == assets::IMPORT_RAW && Body(raw).compare(0, 16, "export default \"") == 0);
+    CHECK(Body(raw).find("\\n") != string::npos);
+
+    auto css = Serve(source, MakeRequest(true, L"/my-plugin/theme.css", L"", referrer));
+    CHECK(css.import == assets::IMPORT_CSS && Body(css).find("stylesheet") != string::npos);
+    CHECK(strcmp(css.mime, "text/javascript") == 0);
+
+    auto url = Serve(source, MakeRequest(true, L"/my-plugin/Logo.png", L"", referrer));
+    CHECK(url.import == assets::IMPORT_URL && Body(url).find("export default url") != string::npos);
+
+    // Wrappers revalidate apart from the file.
+    CHECK(css.etag != Serve(source, MakeRequest(true, L"/my-plugin/theme.css")).etag);
+
+    // Fingerprinted entry, version is content hash.
+    string content(1000, 'a');
+    for (size_t i = 79; i < content.size(); i += 80)
+        content[i] = '\n';
+
+    wchar_t version[32];
+    swprintf(version, COUNT_OF(version), L"v=%llx",
+        static_cast<unsigned long long>(utils::hashContent(content.data(), content.size())));
+
+    auto pinned = Serve(source, MakeRequest(true, L"/my-plugin/", version));
+    CHECK(pinned.status == 200 && pinned.immutable && pinned.preload);
+    CHECK(!Serve(source, MakeRequest(true, L"/my-plugin/", L"v=1234")).immutable);
+    CHECK(Serve(source, MakeRequest(true, L"/my-plugin/", L"x=1&" + wstring(version))).immutable);
+
+    // Trace round trip.
+    auto request = MakeRequest(true, L"/my-plugin/index.js", L"v=1\tx", referrer,
+        { { "Range", L"bytes=0-9" }, { "If-None-Match", L"\"a\"" } });
+    auto response = Serve(source, request);
+    auto line = assets::formatTrace(request, response, L"\\my-plugin\\index.js");
+
+    CHECK(std::count(line.begin(), line.end(), '\t') == 11 && line.back() == '\n');
+
+    vector<std::unique_ptr<assets::TraceRecord>> records{};
+    assets::parseTrace(line + "broken\tline\n" + line, records);
+    CHECK(records.size() == 2);
+
+    if (records.size() == 2)
+    {
+        auto &rec = *records[0];
+        CHECK(rec.request.plugin && rec.request.path == L"/my-plugin/index.js");
+        CHECK(rec.request.query == L"v=1 x" && rec.request.referrer == referrer);
+        CHECK(rec.request.header("range") == L"bytes=0-9" && rec.request.header("If-None-Match") == L"\"a\"");
+        CHECK(rec.request.header("If-Modified-Since").empty() && rec.request.header("Accept").empty());
+        CHECK(rec.status == 206 && rec.path == L"\\my-plugin\\index.js" && rec.size == 1000 && rec.mtime == mtime);
+
+        auto result = assets::replay(source, records, 3);
+        CHECK(result.requests == 2 && result.iterations == 3 && result.mismatches == 0);
+        CHECK(result.p50_us <= result.p99_us && result.p99_us <= result.max_us);
+        CHECK(assets::formatReplay(result, "synthetic").find("status mismatches: 0\n") != string::npos);
+    }
+
+    return CHECK_RESULT();
+}
\ No newline at end of file
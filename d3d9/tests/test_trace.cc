@@ -0,0 +1,158 @@
+#include "check.h"
+#include <string.h>
+#include <sys/wait.h>
+#include <thread>
+
+// Trace writer and clock: spans before the file is opened, output format,
+// concurrent writers and the disabled path.
+
+static vector<string> ReadLines(const string &path)
+{
+    vector<string> lines{};
+    string line{};
+
+    if (FILE *file = fopen(path.c_str(), "rb"))
+    {
+        int c;
+        while ((c = fgetc(file)) != EOF)
+        {
+            if (c != '\n') line.push_back(static_cast<char>(c));
+            else lines.push_back(line), line.clear();
+        }
+        fclose(file);
+    }
+
+    return lines;
+}
+
+static bool Has(const string &line, const string &part)
+{
+    return line.find(part) != string::npos;
+}
+
+static bool IsEvent(const string &line)
+{
+    return line.compare(0, 9, "{\"name\":\"") == 0 && line.size() > 2
+        && line.compare(line.size() - 2, 2, "},") == 0;
+}
+
+// Child process that never gets a file.
+static int RunDisabled()
+{
+    trace::complete("before", 1, 2);
+    trace::open(nullptr, "");
+
+    if (trace::enabled() || trace::asyncBegin("after") != 0)
+        return 1;
+
+    TRACE_SPAN("ignored");
+    return 0;
+}
+
+int main()
+{
+    // Clock is monotonic and in microseconds.
+    int64 t0 = utils::tickMicros();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    int64 t1 = utils::tickMicros();
+
+    CHECK(t1 - t0 >= 15000 && t1 - t0 < 1000000);
+
+    int64 last = utils::tickMicros();
+    bool monotonic = true;
+    for (int i = 0; i < 100000; i++)
+    {
+        int64 now = utils::tickMicros();
+        monotonic = monotonic && now >= last;
+        last = now;
+    }
+    CHECK(monotonic);
+
+    pid_t child = fork();
+    if (child == 0)
+        _exit(RunDisabled());
+
+    int status = 0;
+    CHECK(child > 0 && waitpid(child, &status, 0) == child);
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    // Recorded before open, like spans from DllMain.
+    CHECK(trace::enabled());
+    {
+        TRACE_SPAN("DllMain");
+    }
+    uint64_t id = trace::asyncBegin("plugin \"quoted\"");
+    CHECK(id != 0);
+    trace::complete("Initialize", 100, 250);
+
+    auto dir = MakeTestDir("test_trace");
+    auto path = dir + "/trace.json";
+    FILE *file = fopen(path.c_str(), "wb");
+    CHECK(file != nullptr);
+
+    trace::open(file, "League of \"Legends\".exe");
+    CHECK(trace::enabled());
+
+    // Later opens are ignored.
+    trace::open(nullptr, "other");
+    CHECK(trace::enabled());
+
+    trace::asyncEnd("plugin \"quoted\"", id);
+
+    // Concurrent writers, each event on its own line.
+    const int threads = 8, events = 500;
+    vector<std::thread> workers{};
+
+    for (int t = 0; t < threads; t++)
+    {
+        workers.emplace_back([]
+        {
+            for (int i = 0; i < events; i++)
+            {
+                TRACE_SPAN("worker");
+            }
+        });
+    }
+
+    for (auto &worker : workers)
+        worker.join();
+
+    auto lines = ReadLines(path);
+    auto pid = "\"pid\":" + std::to_string(getpid());
+
+    CHECK(lines.size() == 2 + 4 + threads * events);
+    CHECK(lines.size() > 6 && lines[0] == "[");
+    CHECK(lines.size() > 6 && lines[1] == "{\"name\":\"process_name\",\"ph\":\"M\"," + pid
+        + ",\"args\":{\"name\":\"League of \\\"Legends\\\".exe\"}},");
+
+    if (lines.size() > 6)
+    {
+        // Buffered in order, then written.
+        CHECK(Has(lines[2], "\"name\":\"DllMain\"") && Has(lines[2], "\"ph\":\"X\"") && Has(lines[2], "\"dur\":"));
+        CHECK(Has(lines[3], "\"name\":\"plugin \\\"quoted\\\"\"") && Has(lines[3], "\"ph\":\"b\""));
+        string head = "{\"name\":\"Initialize\",\"cat\":\"loader\",\"ph\":\"X\",\"ts\":100," + pid + ",\"tid\":";
+        string tail = ",\"dur\":250},";
+        CHECK(lines[4].compare(0, head.size(), head) == 0);
+        CHECK(lines[4].size() > tail.size() && lines[4].compare(lines[4].size() - tail.size(), tail.size(), tail) == 0);
+        CHECK(Has(lines[5], "\"ph\":\"e\""));
+
+        // Async pair shares its id.
+        auto id_of = [](const string &line) { return line.substr(line.find("\"id\":")); };
+        CHECK(Has(lines[3], "\"id\":\"0x") && id_of(lines[3]) == id_of(lines[5]));
+    }
+
+    size_t workers_seen = 0, malformed = 0;
+    for (size_t i = 2; i < lines.size(); i++)
+    {
+        if (!IsEvent(lines[i]) || !Has(lines[i], pid))
+            malformed++;
+        if (Has(lines[i], "\"name\":\"worker\""))
+            workers_seen++;
+    }
+
+    CHECK(malformed == 0);
+    CHECK(workers_seen == static_cast<size_t>(threads * events));
+
+    RemoveTree(dir);
+    return CHECK_RESULT();
+}
\ No newline at end of file